@@ -1,6 +1,8 @@
 #include "./AssetStore.h"
+#include "./SkylinePacker.h"
 #include "../Logger/Logger.h"
 #include <SDL_image.h>
+#include <algorithm>
 
 AssetStore::AssetStore()
 {
@@ -15,26 +17,273 @@ AssetStore::~AssetStore()
 
 void AssetStore::ClearAssets()
 {
-	for (auto texture : textures)
+	for (const auto& region : regions)
 	{
-		SDL_DestroyTexture(texture.second);
+		if (region.page < 0 && region.texture)
+		{
+			SDL_DestroyTexture(region.texture);
+		}
+	}
+	for (auto page : atlasPages)
+	{
+		SDL_DestroyTexture(page);
+	}
+	for (const auto& pendingImage : pendingImages)
+	{
+		SDL_FreeSurface(pendingImage.surface);
+	}
+	regions.clear();
+	atlasPages.clear();
+	filePaths.clear();
+	pendingImages.clear();
+	textureHandles.clear();
+}
+
+void AssetStore::FreePendingImage(TextureHandle handle)
+{
+	auto pendingImage = std::find_if(pendingImages.begin(), pendingImages.end(), [handle](const PendingImage& image)
+		{
+			return image.handle == handle;
+		});
+	if (pendingImage != pendingImages.end())
+	{
+		SDL_FreeSurface(pendingImage->surface);
+		pendingImages.erase(pendingImage);
 	}
-	textures.clear();
 }
 
-void AssetStore::AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath)
+TextureHandle AssetStore::AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath)
 {
+	// The sprites get the same handles as in a run that draws, so the simulation does not depend on the mode
+	if (!renderer)
+	{
+		auto existing = textureHandles.find(assetId);
+		if (existing != textureHandles.end())
+		{
+			return existing->second;
+		}
+		const TextureHandle handle = static_cast<TextureHandle>(regions.size());
+		regions.push_back(TextureRegion());
+		filePaths.push_back(std::string());
+		textureHandles.emplace(assetId, handle);
+		return handle;
+	}
+
 	SDL_Surface* surface = IMG_Load(filePath.c_str());
-	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-	SDL_FreeSurface(surface);
+	if (!surface)
+	{
+		Logger::Err("Error loading the texture " + filePath);
+		return INVALID_TEXTURE_HANDLE;
+	}
+
+	// Until the atlas is built the image is drawn from a texture of its own
+	TextureRegion region;
+	region.texture = SDL_CreateTextureFromSurface(renderer, surface);
+	region.rect = { 0, 0, surface->w, surface->h };
+	region.textureWidth = surface->w;
+	region.textureHeight = surface->h;
+
+	// Reloading an asset id keeps its handle, so the sprites using it pick up the new texture
+	TextureHandle handle;
+	auto existing = textureHandles.find(assetId);
+	if (existing != textureHandles.end())
+	{
+		handle = existing->second;
+		if (regions[handle].page < 0)
+		{
+			SDL_DestroyTexture(regions[handle].texture);
+		}
+		FreePendingImage(handle);
+		regions[handle] = region;
+		filePaths[handle] = filePath;
+		Logger::Log("Texture replaced in the Asset Store with id = " + assetId);
+	}
+	else
+	{
+		// Intern the asset id
+		handle = static_cast<TextureHandle>(regions.size());
+		regions.push_back(region);
+		filePaths.push_back(filePath);
+		textureHandles.emplace(assetId, handle);
+		Logger::Log("New texture added to the Asset Store with id = " + assetId);
+	}
+
+	if (surface->w <= ATLAS_MAX_IMAGE_SIZE && surface->h <= ATLAS_MAX_IMAGE_SIZE)
+	{
+		pendingImages.push_back({ handle, surface });
+	}
+	else
+	{
+		SDL_FreeSurface(surface);
+	}
+	return handle;
+}
+
+void AssetStore::BuildAtlas(SDL_Renderer* renderer)
+{
+	if (pendingImages.empty())
+	{
+		return;
+	}
+
+	// Never create pages larger than the renderer supports
+	int pageSize = ATLAS_PAGE_SIZE;
+	SDL_RendererInfo info;
+	if (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0 && info.max_texture_height > 0)
+	{
+		pageSize = std::min(pageSize, std::min(info.max_texture_width, info.max_texture_height));
+	}
+
+	// The skyline packer works best with the tallest images first
+	std::sort(pendingImages.begin(), pendingImages.end(), [](const PendingImage& a, const PendingImage& b)
+		{
+			return a.surface->h != b.surface->h ? a.surface->h > b.surface->h : a.handle < b.handle;
+		});
+
+	size_t first = 0;
+	while (first < pendingImages.size())
+	{
+		// Fill one page
+		SkylinePacker packer(pageSize, pageSize);
+		SDL_Surface* pageSurface = SDL_CreateRGBSurfaceWithFormat(0, pageSize, pageSize, 32, SDL_PIXELFORMAT_RGBA32);
+		const int page = static_cast<int>(atlasPages.size());
+
+		std::vector<std::pair<size_t, SDL_Rect>> placements;
+		size_t next = first;
+		for (; next < pendingImages.size(); next++)
+		{
+			SDL_Surface* surface = pendingImages[next].surface;
+			SDL_Rect rect;
+			if (!packer.Pack(surface->w + ATLAS_PADDING, surface->h + ATLAS_PADDING, rect))
+			{
+				break;
+			}
+			rect.w = surface->w;
+			rect.h = surface->h;
+
+			// Copy the texels as they are, alpha included
+			SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+			SDL_BlitSurface(surface, NULL, pageSurface, &rect);
+			placements.emplace_back(next, rect);
+		}
+
+		// An image too large for an empty page keeps its own texture
+		if (placements.empty())
+		{
+			Logger::Err("Image too large for an atlas page of " + std::to_string(pageSize) + " texels");
+			SDL_FreeSurface(pageSurface);
+			first++;
+			continue;
+		}
+
+		SDL_Texture* pageTexture = SDL_CreateTextureFromSurface(renderer, pageSurface);
+		SDL_SetTextureBlendMode(pageTexture, SDL_BLENDMODE_BLEND);
+		SDL_FreeSurface(pageSurface);
+		atlasPages.push_back(pageTexture);
+
+		// Point the handles at the page, the textures of their own are no longer needed
+		for (const auto& placement : placements)
+		{
+			TextureRegion& region = regions[pendingImages[placement.first].handle];
+			SDL_DestroyTexture(region.texture);
+			region.texture = pageTexture;
+			region.page = page;
+			region.rect = placement.second;
+			region.textureWidth = pageSize;
+			region.textureHeight = pageSize;
+		}
+
+		Logger::Log("Atlas page " + std::to_string(page) + " built with " + std::to_string(placements.size()) + " images");
+		first = next;
+	}
+
+	for (const auto& pendingImage : pendingImages)
+	{
+		SDL_FreeSurface(pendingImage.surface);
+	}
+	pendingImages.clear();
+}
+
+void AssetStore::RestoreTextures(SDL_Renderer* renderer)
+{
+	// The atlas pages are filled again at the same size
+	std::vector<SDL_Surface*> pageSurfaces(atlasPages.size(), nullptr);
+	for (size_t page = 0; page < atlasPages.size(); page++)
+	{
+		int width = 0;
+		int height = 0;
+		SDL_QueryTexture(atlasPages[page], NULL, NULL, &width, &height);
+		SDL_DestroyTexture(atlasPages[page]);
+		atlasPages[page] = nullptr;
+		pageSurfaces[page] = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+	}
+
+	for (size_t handle = 0; handle < regions.size(); handle++)
+	{
+		TextureRegion& region = regions[handle];
+		if (region.page < 0)
+		{
+			SDL_DestroyTexture(region.texture);
+		}
+		region.texture = nullptr;
+		if (filePaths[handle].empty())
+		{
+			continue;
+		}
+
+		SDL_Surface* surface = IMG_Load(filePaths[handle].c_str());
+		if (!surface)
+		{
+			Logger::Err("Error loading the texture " + filePaths[handle]);
+			continue;
+		}
+		if (region.page < 0)
+		{
+			region.texture = SDL_CreateTextureFromSurface(renderer, surface);
+		}
+		else if (pageSurfaces[region.page])
+		{
+			SDL_Rect rect = region.rect;
+			SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+			SDL_BlitSurface(surface, NULL, pageSurfaces[region.page], &rect);
+		}
+		SDL_FreeSurface(surface);
+	}
+
+	for (size_t page = 0; page < atlasPages.size(); page++)
+	{
+		if (!pageSurfaces[page])
+		{
+			Logger::Err("Error restoring the atlas page " + std::to_string(page));
+			continue;
+		}
+		atlasPages[page] = SDL_CreateTextureFromSurface(renderer, pageSurfaces[page]);
+		SDL_SetTextureBlendMode(atlasPages[page], SDL_BLENDMODE_BLEND);
+		SDL_FreeSurface(pageSurfaces[page]);
+	}
+	for (auto& region : regions)
+	{
+		if (region.page >= 0)
+		{
+			region.texture = atlasPages[region.page];
+		}
+	}
 
-	// Add the texture to the map
-	textures.emplace(assetId, texture);
+	Logger::Log("Textures restored after a device reset, " + std::to_string(atlasPages.size()) + " atlas pages");
+}
 
-	Logger::Log("New texture added to the Asset Store with id = " + assetId);
+TextureHandle AssetStore::GetTextureHandle(const std::string& assetId) const
+{
+	auto handle = textureHandles.find(assetId);
+	if (handle == textureHandles.end())
+	{
+		Logger::Err("No texture in the Asset Store with id = " + assetId);
+		return INVALID_TEXTURE_HANDLE;
+	}
+	return handle->second;
 }
 
-SDL_Texture* AssetStore::GetTexture(const std::string& assetId)
+SDL_Texture* AssetStore::GetTexture(const std::string& assetId) const
 {
-	return textures[assetId];
+	return GetTexture(GetTextureHandle(assetId));
 }
@@ -2,21 +2,127 @@
 
 #include<map>
 #include<string>
+#include<vector>
 #include<SDL.h>
+#include<glm/glm.hpp>
+#include "TextureHandle.h"
+
+/*
+* Where the image of a texture handle lives, either a texture of its own or a rectangle of an atlas page
+* Sprites keep their source rectangles relative to their own image, ToTextureRect() moves them into the texture
+*/
+struct TextureRegion
+{
+	SDL_Texture* texture = nullptr;
+	// Index of the atlas page, -1 for an image with a texture of its own
+	int page = -1;
+	// Rectangle of the image inside the texture
+	SDL_Rect rect = { 0, 0, 0, 0 };
+	// Size of the texture, to turn texel coordinates into UVs
+	int textureWidth = 0;
+	int textureHeight = 0;
+
+	SDL_Rect ToTextureRect(const SDL_Rect& srcRect) const
+	{
+		return { rect.x + srcRect.x, rect.y + srcRect.y, srcRect.w, srcRect.h };
+	}
+
+	// UVs of the corners of a source rectangle of the image
+	glm::vec2 GetUVMin(const SDL_Rect& srcRect) const
+	{
+		return glm::vec2(static_cast<float>(rect.x + srcRect.x) / textureWidth, static_cast<float>(rect.y + srcRect.y) / textureHeight);
+	}
+
+	glm::vec2 GetUVMax(const SDL_Rect& srcRect) const
+	{
+		return glm::vec2(static_cast<float>(rect.x + srcRect.x + srcRect.w) / textureWidth, static_cast<float>(rect.y + srcRect.y + srcRect.h) / textureHeight);
+	}
+};
 
 class AssetStore
 {
 private:
-	std::map<std::string, SDL_Texture*> textures;
+	// Images larger than this on any side keep a texture of their own
+	static const int ATLAS_MAX_IMAGE_SIZE = 512;
+	static const int ATLAS_PAGE_SIZE = 2048;
+	// Empty texels between two images so filtering never samples the neighbour
+	static const int ATLAS_PADDING = 1;
+
+	// [Vector index = texture handle]
+	std::vector<TextureRegion> regions;
+
+	// [Vector index = atlas page]
+	std::vector<SDL_Texture*> atlasPages;
+
+	// Where each image was loaded from, to load it again when the renderer loses its textures
+	// [Vector index = texture handle]
+	std::vector<std::string> filePaths;
+
+	// Images waiting for the next BuildAtlas(), they are drawn from their own texture until then
+	struct PendingImage
+	{
+		TextureHandle handle;
+		SDL_Surface* surface;
+	};
+	std::vector<PendingImage> pendingImages;
+
+	// Asset ids interned at load time, only used to resolve a handle from its name
+	std::map<std::string, TextureHandle> textureHandles;
 	//TODO: create a map for fonts
 	// TOFO: create a map for audio
 
+	void FreePendingImage(TextureHandle handle);
+
 public:
 	AssetStore();
 	~AssetStore();
 
 	void ClearAssets();
-	void AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath);
-	SDL_Texture* GetTexture(const std::string& assetId);
 
-};
\ No newline at end of file
+	// Returns the handle of the texture, adding a texture with an existing asset id replaces it and keeps its handle
+	// Without a renderer only the handle is reserved and the image is not even loaded, for the simulation-only runs
+	TextureHandle AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath);
+
+	/*
+	* Pack the small images added since the last call into atlas pages, so sprites using different images can share a texture
+	* Call it once the assets of a level are loaded, the handles stay the same and the sprites do not need to change
+	*/
+	void BuildAtlas(SDL_Renderer* renderer);
+
+	/*
+	* The renderer reset its device and every texture is lost, load the images again into new textures
+	* The atlas pages keep their layout and the handles their regions, only the texture pointers change
+	*/
+	void RestoreTextures(SDL_Renderer* renderer);
+
+	const TextureRegion& GetTextureRegion(TextureHandle handle) const
+	{
+		static const TextureRegion invalidRegion;
+		if (handle < 0 || handle >= static_cast<int>(regions.size()))
+		{
+			return invalidRegion;
+		}
+		return regions[handle];
+	}
+
+	SDL_Texture* GetTexture(TextureHandle handle) const
+	{
+		return GetTextureRegion(handle).texture;
+	}
+
+	// Index shared by every handle drawn from the same texture, the atlas pages first and then the images with a texture of their own
+	int GetTextureSortIndex(TextureHandle handle) const
+	{
+		const TextureRegion& region = GetTextureRegion(handle);
+		return region.page >= 0 ? region.page : static_cast<int>(atlasPages.size()) + handle + 1;
+	}
+
+	int GetNumAtlasPages() const
+	{
+		return static_cast<int>(atlasPages.size());
+	}
+
+	// String lookups for tooling and scripts, they return INVALID_TEXTURE_HANDLE or nullptr for an unknown asset id
+	TextureHandle GetTextureHandle(const std::string& assetId) const;
+	SDL_Texture* GetTexture(const std::string& assetId) const;
+};
@@ -0,0 +1,100 @@
+#include "SkylinePacker.h"
+#include <algorithm>
+#include <climits>
+
+SkylinePacker::SkylinePacker(int width, int height) : width(width), height(height)
+{
+	skyline.push_back({ 0, 0, width });
+}
+
+int SkylinePacker::Fit(size_t index, int rectWidth, int rectHeight) const
+{
+	const int x = skyline[index].x;
+	if (x + rectWidth > width)
+	{
+		return -1;
+	}
+
+	// The rectangle rests on the highest segment below it
+	int y = 0;
+	int remaining = rectWidth;
+	for (size_t i = index; remaining > 0; i++)
+	{
+		y = std::max(y, skyline[i].y);
+		remaining -= skyline[i].width;
+	}
+	return y + rectHeight <= height ? y : -1;
+}
+
+void SkylinePacker::AddSegment(size_t index, const SDL_Rect& rect)
+{
+	skyline.insert(skyline.begin() + index, { rect.x, rect.y + rect.h, rect.w });
+
+	// Shrink or remove the segments now under the new one
+	const int right = rect.x + rect.w;
+	for (size_t i = index + 1; i < skyline.size();)
+	{
+		Segment& segment = skyline[i];
+		if (segment.x >= right)
+		{
+			break;
+		}
+		const int shrink = right - segment.x;
+		if (segment.width <= shrink)
+		{
+			skyline.erase(skyline.begin() + i);
+			continue;
+		}
+		segment.x += shrink;
+		segment.width -= shrink;
+		break;
+	}
+
+	// Merge the neighbours at the same height
+	for (size_t i = 0; i + 1 < skyline.size();)
+	{
+		if (skyline[i].y == skyline[i + 1].y)
+		{
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+bool SkylinePacker::Pack(int rectWidth, int rectHeight, SDL_Rect& rect)
+{
+	int bestTop = INT_MAX;
+	int bestWidth = INT_MAX;
+	size_t bestIndex = 0;
+	int bestY = -1;
+
+	// Lowest top first, then the narrowest segment to leave the wide ones for the next rectangles
+	for (size_t i = 0; i < skyline.size(); i++)
+	{
+		const int y = Fit(i, rectWidth, rectHeight);
+		if (y < 0)
+		{
+			continue;
+		}
+		if (y + rectHeight < bestTop || (y + rectHeight == bestTop && skyline[i].width < bestWidth))
+		{
+			bestTop = y + rectHeight;
+			bestWidth = skyline[i].width;
+			bestIndex = i;
+			bestY = y;
+		}
+	}
+
+	if (bestY < 0)
+	{
+		return false;
+	}
+
+	rect = { skyline[bestIndex].x, bestY, rectWidth, rectHeight };
+	AddSegment(bestIndex, rect);
+	return true;
+}
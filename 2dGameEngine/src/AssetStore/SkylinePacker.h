@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <SDL.h>
+
+/*
+* Skyline bottom-left rectangle packer
+* The top edge of the packed rectangles is kept as a list of horizontal segments, every rectangle goes where its top ends the lowest
+* Packing the rectangles sorted by decreasing height gives the best results
+*/
+class SkylinePacker
+{
+private:
+	struct Segment
+	{
+		int x;
+		int y;
+		int width;
+	};
+
+	int width;
+	int height;
+	// Sorted by x, they cover the whole width of the page
+	std::vector<Segment> skyline;
+
+	// Y at which a rectangle of the given size fits when placed at the start of the segment, -1 if it does not fit
+	int Fit(size_t index, int rectWidth, int rectHeight) const;
+	void AddSegment(size_t index, const SDL_Rect& rect);
+
+public:
+	SkylinePacker(int width, int height);
+
+	// Find a place for a rectangle of the given size, returns false if the page is full
+	bool Pack(int rectWidth, int rectHeight, SDL_Rect& rect);
+};
@@ -0,0 +1,6 @@
+#pragma once
+
+// Dense index of a texture inside the AssetStore, handed out when the texture is loaded
+typedef int TextureHandle;
+
+const TextureHandle INVALID_TEXTURE_HANDLE = -1;
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+/* Axis aligned bounding box in world space */
+struct AABB
+{
+	glm::vec2 min;
+	glm::vec2 max;
+
+	AABB(glm::vec2 min = glm::vec2(0, 0), glm::vec2 max = glm::vec2(0, 0)) : min(min), max(max) {}
+
+	bool Overlaps(const AABB& other) const
+	{
+		return (
+			min.x < other.max.x &&
+			max.x > other.min.x &&
+			min.y < other.max.y &&
+			max.y > other.min.y
+		);
+	}
+};
@@ -0,0 +1,114 @@
+#include "AABBBatch.h"
+#include <SDL.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define AABB_BATCH_X86
+#include <immintrin.h>
+#endif
+
+// GCC and Clang only emit AVX instructions in functions compiled for it, MSVC accepts the intrinsics anywhere
+#if defined(__GNUC__)
+#define TARGET_AVX __attribute__((target("avx")))
+#define TARGET_SSE __attribute__((target("sse")))
+#else
+#define TARGET_AVX
+#define TARGET_SSE
+#endif
+
+static uint32_t LaneMask(int count)
+{
+	return count >= 32 ? 0xFFFFFFFF : (1u << count) - 1;
+}
+
+uint32_t OverlapAABBBatchScalar(const AABB& box, const AABBBatch& batch, int first, int count)
+{
+	uint32_t hits = 0;
+	for (int i = 0; i < count; i++)
+	{
+		const int index = first + i;
+		if (box.min.x < batch.maxX[index] &&
+			box.max.x > batch.minX[index] &&
+			box.min.y < batch.maxY[index] &&
+			box.max.y > batch.minY[index])
+		{
+			hits |= 1u << i;
+		}
+	}
+	return hits;
+}
+
+#ifdef AABB_BATCH_X86
+TARGET_SSE static uint32_t OverlapAABBBatchSSE(const AABB& box, const AABBBatch& batch, int first, int count)
+{
+	const __m128 boxMinX = _mm_set1_ps(box.min.x);
+	const __m128 boxMinY = _mm_set1_ps(box.min.y);
+	const __m128 boxMaxX = _mm_set1_ps(box.max.x);
+	const __m128 boxMaxY = _mm_set1_ps(box.max.y);
+
+	uint32_t hits = 0;
+	for (int lane = 0; lane < count; lane += 4)
+	{
+		const int index = first + lane;
+		const __m128 overlapX = _mm_and_ps(
+			_mm_cmplt_ps(boxMinX, _mm_loadu_ps(&batch.maxX[index])),
+			_mm_cmpgt_ps(boxMaxX, _mm_loadu_ps(&batch.minX[index])));
+		const __m128 overlapY = _mm_and_ps(
+			_mm_cmplt_ps(boxMinY, _mm_loadu_ps(&batch.maxY[index])),
+			_mm_cmpgt_ps(boxMaxY, _mm_loadu_ps(&batch.minY[index])));
+		hits |= static_cast<uint32_t>(_mm_movemask_ps(_mm_and_ps(overlapX, overlapY))) << lane;
+	}
+	return hits & LaneMask(count);
+}
+
+TARGET_AVX static uint32_t OverlapAABBBatchAVX(const AABB& box, const AABBBatch& batch, int first, int count)
+{
+	const __m256 overlapX = _mm256_and_ps(
+		_mm256_cmp_ps(_mm256_set1_ps(box.min.x), _mm256_loadu_ps(&batch.maxX[first]), _CMP_LT_OQ),
+		_mm256_cmp_ps(_mm256_set1_ps(box.max.x), _mm256_loadu_ps(&batch.minX[first]), _CMP_GT_OQ));
+	const __m256 overlapY = _mm256_and_ps(
+		_mm256_cmp_ps(_mm256_set1_ps(box.min.y), _mm256_loadu_ps(&batch.maxY[first]), _CMP_LT_OQ),
+		_mm256_cmp_ps(_mm256_set1_ps(box.max.y), _mm256_loadu_ps(&batch.minY[first]), _CMP_GT_OQ));
+	return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_and_ps(overlapX, overlapY))) & LaneMask(count);
+}
+#endif
+
+typedef uint32_t (*AABBBatchKernel)(const AABB&, const AABBBatch&, int, int);
+
+struct AABBBatchDispatch
+{
+	AABBBatchKernel kernel = OverlapAABBBatchScalar;
+	const char* name = "Scalar";
+
+	AABBBatchDispatch()
+	{
+#ifdef AABB_BATCH_X86
+		// SDL checks both the CPU and the OS support for the wider registers
+		if (SDL_HasAVX())
+		{
+			kernel = OverlapAABBBatchAVX;
+			name = "AVX";
+		}
+		else if (SDL_HasSSE())
+		{
+			kernel = OverlapAABBBatchSSE;
+			name = "SSE";
+		}
+#endif
+	}
+};
+
+static const AABBBatchDispatch& GetDispatch()
+{
+	static AABBBatchDispatch dispatch;
+	return dispatch;
+}
+
+uint32_t OverlapAABBBatch(const AABB& box, const AABBBatch& batch, int first, int count)
+{
+	return GetDispatch().kernel(box, batch, first, count);
+}
+
+const char* GetAABBBatchInstructionSet()
+{
+	return GetDispatch().name;
+}
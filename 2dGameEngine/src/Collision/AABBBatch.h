@@ -0,0 +1,64 @@
+#pragma once
+
+#include "AABB.h"
+#include <vector>
+#include <cstdint>
+
+// Number of boxes tested by one call to OverlapAABBBatch()
+const int AABB_BATCH_WIDTH = 8;
+
+/*
+* Structure of arrays of AABBs for the batch narrowphase
+* The arrays always have AABB_BATCH_WIDTH - 1 slots of padding after the last box so a full batch can be loaded from any index
+*/
+class AABBBatch
+{
+private:
+	int count = 0;
+
+public:
+	std::vector<float> minX;
+	std::vector<float> minY;
+	std::vector<float> maxX;
+	std::vector<float> maxY;
+
+	void Clear()
+	{
+		count = 0;
+	}
+
+	void Add(const AABB& aabb)
+	{
+		if (count + AABB_BATCH_WIDTH > static_cast<int>(minX.size()))
+		{
+			const int size = (count + AABB_BATCH_WIDTH) * 2;
+			minX.resize(size);
+			minY.resize(size);
+			maxX.resize(size);
+			maxY.resize(size);
+		}
+		minX[count] = aabb.min.x;
+		minY[count] = aabb.min.y;
+		maxX[count] = aabb.max.x;
+		maxY[count] = aabb.max.y;
+		count++;
+	}
+
+	int Size() const
+	{
+		return count;
+	}
+};
+
+/*
+* Test one box against up to AABB_BATCH_WIDTH boxes of the batch starting at first
+* Bit i of the result is set if the box overlaps box first + i
+* The widest instruction set available (AVX, SSE or plain C++) is picked at runtime
+*/
+uint32_t OverlapAABBBatch(const AABB& box, const AABBBatch& batch, int first, int count);
+
+// Reference implementation, also used when no SIMD instruction set is available
+uint32_t OverlapAABBBatchScalar(const AABB& box, const AABBBatch& batch, int first, int count);
+
+// Name of the instruction set picked by OverlapAABBBatch()
+const char* GetAABBBatchInstructionSet();
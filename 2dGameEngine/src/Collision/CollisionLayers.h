@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <bit>
+
+const int MAX_COLLISION_LAYERS = 32;
+
+// Layer indices used by the game, a collider layer is a bitfield so the layer index n is the bit (1 << n)
+enum CollisionLayer
+{
+	COLLISION_LAYER_DEFAULT,
+	COLLISION_LAYER_PLAYER,
+	COLLISION_LAYER_ENEMY,
+	COLLISION_LAYER_PLAYER_PROJECTILE,
+	COLLISION_LAYER_ENEMY_PROJECTILE,
+	COLLISION_LAYER_TERRAIN
+};
+
+inline uint32_t LayerBit(int layer)
+{
+	return 1u << layer;
+}
+
+// Two colliders can collide only if each one's layer is in the other's mask
+inline bool ShouldCollide(uint32_t aLayer, uint32_t aMask, uint32_t bLayer, uint32_t bMask)
+{
+	return (aLayer & bMask) != 0 && (bLayer & aMask) != 0;
+}
+
+/*
+* Symmetric matrix saying which layers collide with each other, every layer collides with every other layer by default
+* Row n is the mask of layer n
+*/
+class CollisionLayerMatrix
+{
+private:
+	uint32_t masks[MAX_COLLISION_LAYERS];
+
+public:
+	CollisionLayerMatrix()
+	{
+		for (int i = 0; i < MAX_COLLISION_LAYERS; i++)
+		{
+			masks[i] = 0xFFFFFFFF;
+		}
+	}
+
+	void SetCollision(int layerA, int layerB, bool collide)
+	{
+		if (collide)
+		{
+			masks[layerA] |= LayerBit(layerB);
+			masks[layerB] |= LayerBit(layerA);
+		}
+		else
+		{
+			masks[layerA] &= ~LayerBit(layerB);
+			masks[layerB] &= ~LayerBit(layerA);
+		}
+	}
+
+	bool CanCollide(int layerA, int layerB) const
+	{
+		return (masks[layerA] & LayerBit(layerB)) != 0;
+	}
+
+	// Mask of a layer bitfield, the union of the rows of every layer set in it
+	uint32_t GetMask(uint32_t layers) const
+	{
+		uint32_t mask = 0;
+		while (layers != 0)
+		{
+			mask |= masks[std::countr_zero(layers)];
+			layers &= layers - 1;
+		}
+		return mask;
+	}
+};
@@ -0,0 +1,285 @@
+#include "DynamicAABBTree.h"
+#include <algorithm>
+
+DynamicAABBTree::DynamicAABBTree(float margin) : margin(margin)
+{
+}
+
+AABB DynamicAABBTree::Union(const AABB& a, const AABB& b)
+{
+	return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+}
+
+float DynamicAABBTree::Perimeter(const AABB& aabb)
+{
+	return 2.0f * ((aabb.max.x - aabb.min.x) + (aabb.max.y - aabb.min.y));
+}
+
+int DynamicAABBTree::AllocateNode()
+{
+	if (freeList == NULL_NODE)
+	{
+		nodes.emplace_back();
+		return static_cast<int>(nodes.size()) - 1;
+	}
+
+	const int node = freeList;
+	freeList = nodes[node].id;
+	nodes[node] = Node();
+	return node;
+}
+
+void DynamicAABBTree::FreeNode(int node)
+{
+	nodes[node].height = -1;
+	nodes[node].id = freeList;
+	freeList = node;
+}
+
+int DynamicAABBTree::CreateProxy(const AABB& aabb, int id, uint32_t layer)
+{
+	const int leaf = AllocateNode();
+	nodes[leaf].aabb = AABB(aabb.min - glm::vec2(margin), aabb.max + glm::vec2(margin));
+	nodes[leaf].id = id;
+	nodes[leaf].layers = layer;
+	nodes[leaf].height = 0;
+	InsertLeaf(leaf);
+	return leaf;
+}
+
+void DynamicAABBTree::DestroyProxy(int node)
+{
+	RemoveLeaf(node);
+	FreeNode(node);
+}
+
+bool DynamicAABBTree::MoveProxy(int node, const AABB& aabb)
+{
+	const AABB& fatAABB = nodes[node].aabb;
+	if (fatAABB.min.x <= aabb.min.x && fatAABB.min.y <= aabb.min.y && fatAABB.max.x >= aabb.max.x && fatAABB.max.y >= aabb.max.y)
+	{
+		return false;
+	}
+
+	RemoveLeaf(node);
+	nodes[node].aabb = AABB(aabb.min - glm::vec2(margin), aabb.max + glm::vec2(margin));
+	InsertLeaf(node);
+	return true;
+}
+
+const AABB& DynamicAABBTree::GetFatAABB(int node) const
+{
+	return nodes[node].aabb;
+}
+
+int DynamicAABBTree::GetId(int node) const
+{
+	return nodes[node].id;
+}
+
+int DynamicAABBTree::GetHeight() const
+{
+	return root == NULL_NODE ? 0 : nodes[root].height;
+}
+
+void DynamicAABBTree::Clear()
+{
+	nodes.clear();
+	root = NULL_NODE;
+	freeList = NULL_NODE;
+}
+
+void DynamicAABBTree::InsertLeaf(int leaf)
+{
+	if (root == NULL_NODE)
+	{
+		root = leaf;
+		nodes[root].parent = NULL_NODE;
+		return;
+	}
+
+	// Walk down choosing the child that grows the least, using the perimeter as the surface area heuristic
+	const AABB leafAABB = nodes[leaf].aabb;
+	int index = root;
+	while (!nodes[index].IsLeaf())
+	{
+		const Node& node = nodes[index];
+		const float area = Perimeter(node.aabb);
+		const float combinedArea = Perimeter(Union(node.aabb, leafAABB));
+
+		// Cost of creating a new parent for this node and the new leaf
+		const float cost = 2.0f * combinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree
+		const float inheritanceCost = 2.0f * (combinedArea - area);
+
+		auto childCost = [&](int child)
+		{
+			const AABB merged = Union(leafAABB, nodes[child].aabb);
+			if (nodes[child].IsLeaf())
+			{
+				return Perimeter(merged) + inheritanceCost;
+			}
+			return (Perimeter(merged) - Perimeter(nodes[child].aabb)) + inheritanceCost;
+		};
+
+		const float leftCost = childCost(node.left);
+		const float rightCost = childCost(node.right);
+
+		if (cost < leftCost && cost < rightCost)
+		{
+			break;
+		}
+		index = leftCost < rightCost ? node.left : node.right;
+	}
+
+	// Create a new parent for the sibling and the leaf
+	const int sibling = index;
+	const int oldParent = nodes[sibling].parent;
+	const int newParent = AllocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].aabb = Union(leafAABB, nodes[sibling].aabb);
+	nodes[newParent].layers = nodes[leaf].layers | nodes[sibling].layers;
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].left = sibling;
+	nodes[newParent].right = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent == NULL_NODE)
+	{
+		root = newParent;
+	}
+	else if (nodes[oldParent].left == sibling)
+	{
+		nodes[oldParent].left = newParent;
+	}
+	else
+	{
+		nodes[oldParent].right = newParent;
+	}
+
+	FixUpwards(nodes[leaf].parent);
+}
+
+void DynamicAABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == root)
+	{
+		root = NULL_NODE;
+		return;
+	}
+
+	const int parent = nodes[leaf].parent;
+	const int grandParent = nodes[parent].parent;
+	const int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+	// The sibling takes the place of the parent
+	if (grandParent == NULL_NODE)
+	{
+		root = sibling;
+		nodes[sibling].parent = NULL_NODE;
+	}
+	else
+	{
+		if (nodes[grandParent].left == parent)
+		{
+			nodes[grandParent].left = sibling;
+		}
+		else
+		{
+			nodes[grandParent].right = sibling;
+		}
+		nodes[sibling].parent = grandParent;
+		FixUpwards(grandParent);
+	}
+	FreeNode(parent);
+	nodes[leaf].parent = NULL_NODE;
+}
+
+void DynamicAABBTree::FixUpwards(int index)
+{
+	while (index != NULL_NODE)
+	{
+		index = Balance(index);
+
+		Node& node = nodes[index];
+		node.height = 1 + std::max(nodes[node.left].height, nodes[node.right].height);
+		node.aabb = Union(nodes[node.left].aabb, nodes[node.right].aabb);
+		node.layers = nodes[node.left].layers | nodes[node.right].layers;
+
+		index = node.parent;
+	}
+}
+
+/*
+* Perform a left or right rotation if the node is imbalanced
+* Returns the index of the node that took its place in the tree
+*/
+int DynamicAABBTree::Balance(int a)
+{
+	if (nodes[a].IsLeaf() || nodes[a].height < 2)
+	{
+		return a;
+	}
+
+	const int b = nodes[a].left;
+	const int c = nodes[a].right;
+	const int balance = nodes[c].height - nodes[b].height;
+
+	// Rotate the taller child up, the promoted child keeps its taller grandchild and hands the other one to the old parent
+	auto rotate = [&](int up, int other, bool upIsRight)
+	{
+		const int f = nodes[up].left;
+		const int g = nodes[up].right;
+
+		nodes[up].left = a;
+		nodes[up].parent = nodes[a].parent;
+		nodes[a].parent = up;
+
+		if (nodes[up].parent == NULL_NODE)
+		{
+			root = up;
+		}
+		else if (nodes[nodes[up].parent].left == a)
+		{
+			nodes[nodes[up].parent].left = up;
+		}
+		else
+		{
+			nodes[nodes[up].parent].right = up;
+		}
+
+		const int keep = nodes[f].height > nodes[g].height ? f : g;
+		const int give = keep == f ? g : f;
+
+		nodes[up].right = keep;
+		if (upIsRight)
+		{
+			nodes[a].right = give;
+		}
+		else
+		{
+			nodes[a].left = give;
+		}
+		nodes[give].parent = a;
+
+		nodes[a].aabb = Union(nodes[other].aabb, nodes[give].aabb);
+		nodes[a].layers = nodes[other].layers | nodes[give].layers;
+		nodes[a].height = 1 + std::max(nodes[other].height, nodes[give].height);
+		nodes[up].aabb = Union(nodes[a].aabb, nodes[keep].aabb);
+		nodes[up].layers = nodes[a].layers | nodes[keep].layers;
+		nodes[up].height = 1 + std::max(nodes[a].height, nodes[keep].height);
+		return up;
+	};
+
+	if (balance > 1)
+	{
+		return rotate(c, b, true);
+	}
+	if (balance < -1)
+	{
+		return rotate(b, c, false);
+	}
+	return a;
+}
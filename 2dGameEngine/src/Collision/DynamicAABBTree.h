@@ -0,0 +1,153 @@
+#pragma once
+
+#include "AABB.h"
+#include "SweptAABB.h"
+#include <vector>
+
+/*
+* Dynamic bounding volume hierarchy of AABBs
+* Leaves store a fattened AABB so a proxy that moves a little stays inside its leaf and the tree is left untouched,
+* only proxies that leave their fat AABB are removed and reinserted. Tree rotations keep the tree balanced so queries stay logarithmic.
+*/
+class DynamicAABBTree
+{
+private:
+	static const int NULL_NODE = -1;
+
+	struct Node
+	{
+		AABB aabb;
+		int parent = NULL_NODE;
+		int left = NULL_NODE;
+		int right = NULL_NODE;
+		// Leaves have a height of 0, free nodes -1
+		int height = -1;
+		// Id of the proxy stored in a leaf, the free list reuses it as the next free node
+		int id = NULL_NODE;
+		// Union of the collision layers of every leaf below this node
+		uint32_t layers = 0;
+
+		bool IsLeaf() const
+		{
+			return left == NULL_NODE;
+		}
+	};
+
+	std::vector<Node> nodes;
+	int root = NULL_NODE;
+	int freeList = NULL_NODE;
+	float margin;
+
+	// Scratch stack reused by the queries so they never allocate once warmed up
+	mutable std::vector<int> stack;
+
+	int AllocateNode();
+	void FreeNode(int node);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int Balance(int node);
+	void FixUpwards(int node);
+
+	static AABB Union(const AABB& a, const AABB& b);
+	static float Perimeter(const AABB& aabb);
+
+public:
+	DynamicAABBTree(float margin = 16.0f);
+
+	// Returns the leaf node of the new proxy, the fat AABB is the given AABB grown by the margin
+	int CreateProxy(const AABB& aabb, int id, uint32_t layer = 0xFFFFFFFF);
+	void DestroyProxy(int node);
+
+	// Reinserts the proxy only if the new AABB left its fat AABB, returns true if the tree changed
+	bool MoveProxy(int node, const AABB& aabb);
+
+	const AABB& GetFatAABB(int node) const;
+	int GetId(int node) const;
+	int GetHeight() const;
+	void Clear();
+
+	/*
+	* Call callback(id) for every proxy whose fat AABB overlaps the given AABB and whose layer is in the mask
+	* Whole subtrees without any layer of the mask are skipped, the callback returns false to stop the query
+	*/
+	template <typename TCallback>
+	void Query(const AABB& aabb, uint32_t mask, TCallback callback) const
+	{
+		if (root == NULL_NODE)
+		{
+			return;
+		}
+
+		stack.clear();
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			const int index = stack.back();
+			stack.pop_back();
+
+			const Node& node = nodes[index];
+			if ((node.layers & mask) == 0 || !node.aabb.Overlaps(aabb))
+			{
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				if (!callback(node.id))
+				{
+					return;
+				}
+			}
+			else
+			{
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+	}
+
+	/*
+	* Call callback(id) for every proxy whose fat AABB is crossed by the segment from start to end up to maxFraction,
+	* and whose layer is in the mask
+	* The callback returns the new maxFraction, usually the fraction of its hit, so the nodes behind it are skipped. Returning 0 stops the ray cast.
+	*/
+	template <typename TCallback>
+	void Raycast(glm::vec2 start, glm::vec2 end, uint32_t mask, float maxFraction, TCallback callback) const
+	{
+		if (root == NULL_NODE)
+		{
+			return;
+		}
+
+		const glm::vec2 displacement = end - start;
+		stack.clear();
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			const int index = stack.back();
+			stack.pop_back();
+
+			const Node& node = nodes[index];
+			float fraction;
+			glm::vec2 normal;
+			if ((node.layers & mask) == 0 || !RaycastAABB(start, displacement, node.aabb, fraction, normal) || fraction > maxFraction)
+			{
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				maxFraction = callback(node.id);
+				if (maxFraction <= 0.0f)
+				{
+					return;
+				}
+			}
+			else
+			{
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+	}
+};
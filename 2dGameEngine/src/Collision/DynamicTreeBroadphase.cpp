@@ -0,0 +1,151 @@
+#include "DynamicTreeBroadphase.h"
+#include <algorithm>
+#include "SweptAABB.h"
+
+// Static colliders never move, so their leaves do not need to be fattened
+DynamicTreeBroadphase::DynamicTreeBroadphase(float margin) : staticTree(0.0f), dynamicTree(margin)
+{
+}
+
+void DynamicTreeBroadphase::InsertOrUpdate(int id, const AABB& aabb, bool isStatic, uint32_t layer, uint32_t mask)
+{
+	if (id >= static_cast<int>(proxies.size()))
+	{
+		proxies.resize(id + 1);
+	}
+
+	auto& proxy = proxies[id];
+	// The layer is baked into the tree nodes, so a layer change needs a reinsertion
+	if (proxy.isActive && (proxy.isStatic != isStatic || proxy.layer != layer))
+	{
+		Remove(id);
+	}
+
+	proxy.aabb = aabb;
+	proxy.mask = mask;
+	if (!proxy.isActive)
+	{
+		proxy.isActive = true;
+		proxy.isStatic = isStatic;
+		proxy.layer = layer;
+		proxy.node = (isStatic ? staticTree : dynamicTree).CreateProxy(aabb, id, layer);
+		if (!isStatic)
+		{
+			dynamicIds.push_back(id);
+		}
+		return;
+	}
+
+	// Only the proxies that left their fat AABB are reinserted
+	(isStatic ? staticTree : dynamicTree).MoveProxy(proxy.node, aabb);
+}
+
+void DynamicTreeBroadphase::Remove(int id)
+{
+	if (id >= static_cast<int>(proxies.size()) || !proxies[id].isActive)
+	{
+		return;
+	}
+
+	auto& proxy = proxies[id];
+	if (proxy.isStatic)
+	{
+		staticTree.DestroyProxy(proxy.node);
+	}
+	else
+	{
+		dynamicTree.DestroyProxy(proxy.node);
+		dynamicIds.erase(std::find(dynamicIds.begin(), dynamicIds.end(), id));
+	}
+	proxy.isActive = false;
+	proxy.node = -1;
+}
+
+void DynamicTreeBroadphase::Clear()
+{
+	staticTree.Clear();
+	dynamicTree.Clear();
+	proxies.clear();
+	dynamicIds.clear();
+}
+
+const AABB& DynamicTreeBroadphase::GetAABB(int id) const
+{
+	return proxies[id].aabb;
+}
+
+void DynamicTreeBroadphase::FindPairs(std::vector<std::pair<int, int>>& pairs)
+{
+	for (int id : dynamicIds)
+	{
+		const Proxy& proxy = proxies[id];
+		const AABB& fatAABB = dynamicTree.GetFatAABB(proxy.node);
+
+		// Dynamic vs dynamic, both proxies find each other so keep the pair only from the lower id
+		dynamicTree.Query(fatAABB, proxy.mask, [&](int other)
+			{
+				if (other > id && (proxies[other].mask & proxy.layer) != 0)
+				{
+					pairs.emplace_back(id, other);
+				}
+				return true;
+			});
+
+		// Dynamic vs static
+		staticTree.Query(fatAABB, proxy.mask, [&](int other)
+			{
+				if ((proxies[other].mask & proxy.layer) != 0)
+				{
+					pairs.emplace_back(std::min(id, other), std::max(id, other));
+				}
+				return true;
+			});
+	}
+}
+
+void DynamicTreeBroadphase::Query(const AABB& aabb, uint32_t mask, IQueryCallback& callback) const
+{
+	// The leaves hold fat AABBs, so check the actual AABB of the proxy before reporting it
+	bool isStopped = false;
+	auto report = [&](int id)
+	{
+		if (proxies[id].aabb.Overlaps(aabb) && !callback.Report(id))
+		{
+			isStopped = true;
+		}
+		return !isStopped;
+	};
+
+	dynamicTree.Query(aabb, mask, report);
+	if (!isStopped)
+	{
+		staticTree.Query(aabb, mask, report);
+	}
+}
+
+bool DynamicTreeBroadphase::Raycast(glm::vec2 start, glm::vec2 end, uint32_t mask, int& id, float& fraction, glm::vec2& normal) const
+{
+	const glm::vec2 displacement = end - start;
+	bool hasHit = false;
+	float maxFraction = 1.0f;
+
+	// Every hit shortens the segment, so the rest of both trees only visits nodes in front of the closest hit so far
+	auto report = [&](int proxyId)
+	{
+		float hitFraction;
+		glm::vec2 hitNormal;
+		if (RaycastAABB(start, displacement, proxies[proxyId].aabb, hitFraction, hitNormal) && (!hasHit || hitFraction < maxFraction))
+		{
+			id = proxyId;
+			fraction = hitFraction;
+			normal = hitNormal;
+			maxFraction = hitFraction;
+			hasHit = true;
+		}
+		return maxFraction;
+	};
+
+	dynamicTree.Raycast(start, end, mask, maxFraction, report);
+	staticTree.Raycast(start, end, mask, maxFraction, report);
+	return hasHit;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "AABB.h"
+#include "IBroadphase.h"
+#include "DynamicAABBTree.h"
+#include <vector>
+#include <utility>
+
+/*
+* Broadphase built on two dynamic AABB trees, one for the static colliders and one for the dynamic ones
+* Only the dynamic proxies query the trees, so the static level geometry costs a log time query per dynamic collider
+* and static vs static pairs are never examined
+* Tree nodes know the layers below them, so the queries skip whole subtrees of layers the querying proxy ignores
+*/
+class DynamicTreeBroadphase : public IBroadphase
+{
+private:
+	struct Proxy
+	{
+		AABB aabb;
+		int node = -1;
+		uint32_t layer = 0;
+		uint32_t mask = 0;
+		bool isStatic = false;
+		bool isActive = false;
+	};
+
+	DynamicAABBTree staticTree;
+	DynamicAABBTree dynamicTree;
+
+	// [Vector index = proxy id]
+	std::vector<Proxy> proxies;
+
+	// Ids of the active dynamic proxies, the only ones that run queries
+	std::vector<int> dynamicIds;
+
+public:
+	DynamicTreeBroadphase(float margin = 16.0f);
+
+	void InsertOrUpdate(int id, const AABB& aabb, bool isStatic, uint32_t layer, uint32_t mask) override;
+	void Remove(int id) override;
+	void Clear() override;
+	const AABB& GetAABB(int id) const override;
+
+	// Candidate pairs are proxies whose fat AABBs overlap
+	void FindPairs(std::vector<std::pair<int, int>>& pairs) override;
+
+	void Query(const AABB& aabb, uint32_t mask, IQueryCallback& callback) const override;
+	bool Raycast(glm::vec2 start, glm::vec2 end, uint32_t mask, int& id, float& fraction, glm::vec2& normal) const override;
+};
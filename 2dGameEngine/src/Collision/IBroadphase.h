@@ -0,0 +1,50 @@
+#pragma once
+
+#include "AABB.h"
+#include "CollisionLayers.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <utility>
+
+enum BroadphaseType
+{
+	BROADPHASE_SPATIAL_HASH,
+	BROADPHASE_SWEEP_AND_PRUNE,
+	BROADPHASE_DYNAMIC_TREE
+};
+
+// Receives the proxies found by a broadphase query, returning false stops the query
+class IQueryCallback
+{
+public:
+	virtual ~IQueryCallback() = default;
+	virtual bool Report(int id) = 0;
+};
+
+/*
+* Interface shared by the broadphases of the CollisionSystem
+* A broadphase keeps one proxy per collider, keyed by the entity id, and returns the pairs of proxies that may overlap
+* Pairs where both proxies are static, or whose layers and masks do not match, are rejected before any geometry test
+*/
+class IBroadphase
+{
+public:
+	virtual ~IBroadphase() = default;
+
+	virtual void InsertOrUpdate(int id, const AABB& aabb, bool isStatic, uint32_t layer, uint32_t mask) = 0;
+	virtual void Remove(int id) = 0;
+	virtual void Clear() = 0;
+	virtual const AABB& GetAABB(int id) const = 0;
+
+	// Append the candidate pairs, each pair is reported once as (lower id, higher id)
+	virtual void FindPairs(std::vector<std::pair<int, int>>& pairs) = 0;
+
+	// Report every proxy whose AABB overlaps the given AABB and whose layer is in the mask, each proxy is reported once
+	virtual void Query(const AABB& aabb, uint32_t mask, IQueryCallback& callback) const = 0;
+
+	/*
+	* Closest proxy crossed by the segment from start to end whose layer is in the mask
+	* fraction is the part of the segment before the hit and normal the face that was hit, a segment starting inside a proxy hits it at 0
+	*/
+	virtual bool Raycast(glm::vec2 start, glm::vec2 end, uint32_t mask, int& id, float& fraction, glm::vec2& normal) const = 0;
+};
@@ -0,0 +1,283 @@
+#include "SpatialHashGrid.h"
+#include <algorithm>
+#include <cmath>
+#include "SweptAABB.h"
+
+SpatialHashGrid::SpatialHashGrid(float cellSize) : cellSize(cellSize)
+{
+}
+
+long long SpatialHashGrid::CellKey(int x, int y)
+{
+	return (static_cast<long long>(x) << 32) | static_cast<unsigned int>(y);
+}
+
+SpatialHashGrid::CellRange SpatialHashGrid::ComputeCellRange(const AABB& aabb) const
+{
+	return {
+		static_cast<int>(std::floor(aabb.min.x / cellSize)),
+		static_cast<int>(std::floor(aabb.min.y / cellSize)),
+		static_cast<int>(std::floor(aabb.max.x / cellSize)),
+		static_cast<int>(std::floor(aabb.max.y / cellSize))
+	};
+}
+
+void SpatialHashGrid::AddToCells(int id, const CellRange& range)
+{
+	for (int y = range.minY; y <= range.maxY; y++)
+	{
+		for (int x = range.minX; x <= range.maxX; x++)
+		{
+			auto& cell = cells[CellKey(x, y)];
+			cell.x = x;
+			cell.y = y;
+			cell.ids.push_back(id);
+		}
+	}
+}
+
+void SpatialHashGrid::RemoveFromCells(int id, const CellRange& range)
+{
+	for (int y = range.minY; y <= range.maxY; y++)
+	{
+		for (int x = range.minX; x <= range.maxX; x++)
+		{
+			auto cell = cells.find(CellKey(x, y));
+			if (cell == cells.end())
+			{
+				continue;
+			}
+
+			// Order inside a cell does not matter, so swap with the last id instead of shifting the vector
+			auto& ids = cell->second.ids;
+			auto it = std::find(ids.begin(), ids.end(), id);
+			if (it != ids.end())
+			{
+				*it = ids.back();
+				ids.pop_back();
+			}
+			if (ids.empty())
+			{
+				cells.erase(cell);
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::SetCellSize(float cellSize)
+{
+	this->cellSize = cellSize;
+	cells.clear();
+
+	for (int id = 0; id < static_cast<int>(proxies.size()); id++)
+	{
+		auto& proxy = proxies[id];
+		if (proxy.isActive)
+		{
+			proxy.cells = ComputeCellRange(proxy.aabb);
+			AddToCells(id, proxy.cells);
+		}
+	}
+}
+
+float SpatialHashGrid::GetCellSize() const
+{
+	return cellSize;
+}
+
+void SpatialHashGrid::InsertOrUpdate(int id, const AABB& aabb, bool isStatic, uint32_t layer, uint32_t mask)
+{
+	if (id >= static_cast<int>(proxies.size()))
+	{
+		proxies.resize(id + 1);
+	}
+
+	auto& proxy = proxies[id];
+	proxy.aabb = aabb;
+	proxy.isStatic = isStatic;
+	proxy.layer = layer;
+	proxy.mask = mask;
+	const CellRange range = ComputeCellRange(aabb);
+
+	if (!proxy.isActive)
+	{
+		proxy.isActive = true;
+		proxy.cells = range;
+		AddToCells(id, range);
+	}
+	else if (!(proxy.cells == range))
+	{
+		// Only rebin when the proxy crossed a cell boundary
+		RemoveFromCells(id, proxy.cells);
+		proxy.cells = range;
+		AddToCells(id, range);
+	}
+}
+
+void SpatialHashGrid::Remove(int id)
+{
+	if (id >= static_cast<int>(proxies.size()) || !proxies[id].isActive)
+	{
+		return;
+	}
+	RemoveFromCells(id, proxies[id].cells);
+	proxies[id].isActive = false;
+}
+
+void SpatialHashGrid::Clear()
+{
+	proxies.clear();
+	cells.clear();
+}
+
+const AABB& SpatialHashGrid::GetAABB(int id) const
+{
+	return proxies[id].aabb;
+}
+
+void SpatialHashGrid::FindPairs(std::vector<std::pair<int, int>>& pairs)
+{
+	for (const auto& entry : cells)
+	{
+		const Cell& cell = entry.second;
+		const auto& ids = cell.ids;
+
+		for (size_t i = 0; i < ids.size(); i++)
+		{
+			const Proxy& aProxy = proxies[ids[i]];
+			const CellRange& a = aProxy.cells;
+
+			for (size_t j = i + 1; j < ids.size(); j++)
+			{
+				const Proxy& bProxy = proxies[ids[j]];
+				const CellRange& b = bProxy.cells;
+
+				if ((aProxy.isStatic && bProxy.isStatic) || !ShouldCollide(aProxy.layer, aProxy.mask, bProxy.layer, bProxy.mask))
+				{
+					continue;
+				}
+
+				// Two proxies can share several cells, only report the pair from the first cell of their shared range
+				if (cell.x != std::max(a.minX, b.minX) || cell.y != std::max(a.minY, b.minY))
+				{
+					continue;
+				}
+
+				pairs.emplace_back(std::min(ids[i], ids[j]), std::max(ids[i], ids[j]));
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::Query(const AABB& aabb, uint32_t mask, IQueryCallback& callback) const
+{
+	const CellRange range = ComputeCellRange(aabb);
+
+	// Proxies overlapping the box are binned in several cells, only report them from the first cell they share with the box
+	auto queryCell = [&](const Cell& cell)
+	{
+		for (int id : cell.ids)
+		{
+			const Proxy& proxy = proxies[id];
+			if ((proxy.layer & mask) == 0 || !proxy.aabb.Overlaps(aabb))
+			{
+				continue;
+			}
+			if (cell.x != std::max(proxy.cells.minX, range.minX) || cell.y != std::max(proxy.cells.minY, range.minY))
+			{
+				continue;
+			}
+			if (!callback.Report(id))
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	// A box covering more cells than there are occupied cells is cheaper to answer by walking the occupied cells
+	const long long numCells = static_cast<long long>(range.maxX - range.minX + 1) * (range.maxY - range.minY + 1);
+	if (numCells > static_cast<long long>(cells.size()))
+	{
+		for (const auto& entry : cells)
+		{
+			const Cell& cell = entry.second;
+			if (cell.x >= range.minX && cell.x <= range.maxX && cell.y >= range.minY && cell.y <= range.maxY && !queryCell(cell))
+			{
+				return;
+			}
+		}
+		return;
+	}
+
+	for (int y = range.minY; y <= range.maxY; y++)
+	{
+		for (int x = range.minX; x <= range.maxX; x++)
+		{
+			auto cell = cells.find(CellKey(x, y));
+			if (cell != cells.end() && !queryCell(cell->second))
+			{
+				return;
+			}
+		}
+	}
+}
+
+bool SpatialHashGrid::Raycast(glm::vec2 start, glm::vec2 end, uint32_t mask, int& id, float& fraction, glm::vec2& normal) const
+{
+	const glm::vec2 displacement = end - start;
+
+	// Walk the cells crossed by the segment in order (Amanatides and Woo)
+	int x = static_cast<int>(std::floor(start.x / cellSize));
+	int y = static_cast<int>(std::floor(start.y / cellSize));
+	const int endX = static_cast<int>(std::floor(end.x / cellSize));
+	const int endY = static_cast<int>(std::floor(end.y / cellSize));
+	const int stepX = displacement.x > 0.0f ? 1 : -1;
+	const int stepY = displacement.y > 0.0f ? 1 : -1;
+
+	// Fraction of the segment at which it crosses the next cell border on each axis, and the fraction needed to cross a whole cell
+	float nextX = displacement.x != 0.0f ? ((x + (stepX > 0 ? 1 : 0)) * cellSize - start.x) / displacement.x : INFINITY;
+	float nextY = displacement.y != 0.0f ? ((y + (stepY > 0 ? 1 : 0)) * cellSize - start.y) / displacement.y : INFINITY;
+	const float deltaX = displacement.x != 0.0f ? cellSize / std::abs(displacement.x) : INFINITY;
+	const float deltaY = displacement.y != 0.0f ? cellSize / std::abs(displacement.y) : INFINITY;
+
+	bool hasHit = false;
+	while (true)
+	{
+		auto cell = cells.find(CellKey(x, y));
+		if (cell != cells.end())
+		{
+			for (int cellId : cell->second.ids)
+			{
+				const Proxy& proxy = proxies[cellId];
+				float hitFraction;
+				glm::vec2 hitNormal;
+				if ((proxy.layer & mask) != 0 && RaycastAABB(start, displacement, proxy.aabb, hitFraction, hitNormal) && (!hasHit || hitFraction < fraction))
+				{
+					id = cellId;
+					fraction = hitFraction;
+					normal = hitNormal;
+					hasHit = true;
+				}
+			}
+		}
+
+		// Any proxy hit closer than the exit of this cell is binned in a cell already visited, so the hit found is the closest
+		const float cellExit = std::min(nextX, nextY);
+		if ((hasHit && fraction <= cellExit) || (x == endX && y == endY) || cellExit > 1.0f)
+		{
+			return hasHit;
+		}
+
+		if (nextX < nextY)
+		{
+			x += stepX;
+			nextX += deltaX;
+		}
+		else
+		{
+			y += stepY;
+			nextY += deltaY;
+		}
+	}
+}
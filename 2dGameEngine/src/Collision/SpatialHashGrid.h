@@ -0,0 +1,76 @@
+#pragma once
+
+#include "AABB.h"
+#include "IBroadphase.h"
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+/*
+* Uniform grid broadphase, the grid is unbounded because cells are stored in a hash map keyed by their coordinates
+* Every proxy is binned into all the cells its AABB touches and is only rebinned when it crosses a cell boundary
+*/
+class SpatialHashGrid : public IBroadphase
+{
+private:
+	struct CellRange
+	{
+		int minX;
+		int minY;
+		int maxX;
+		int maxY;
+
+		bool operator ==(const CellRange& other) const
+		{
+			return minX == other.minX && minY == other.minY && maxX == other.maxX && maxY == other.maxY;
+		}
+	};
+
+	struct Proxy
+	{
+		AABB aabb;
+		CellRange cells;
+		uint32_t layer = 0;
+		uint32_t mask = 0;
+		bool isStatic = false;
+		bool isActive = false;
+	};
+
+	struct Cell
+	{
+		int x;
+		int y;
+		std::vector<int> ids;
+	};
+
+	float cellSize;
+
+	// [Vector index = proxy id]
+	std::vector<Proxy> proxies;
+
+	// [Map key = packed cell coordinates]
+	std::unordered_map<long long, Cell> cells;
+
+	static long long CellKey(int x, int y);
+	CellRange ComputeCellRange(const AABB& aabb) const;
+	void AddToCells(int id, const CellRange& range);
+	void RemoveFromCells(int id, const CellRange& range);
+
+public:
+	SpatialHashGrid(float cellSize = 128.0f);
+
+	// Changing the cell size rebins every proxy
+	void SetCellSize(float cellSize);
+	float GetCellSize() const;
+
+	void InsertOrUpdate(int id, const AABB& aabb, bool isStatic, uint32_t layer, uint32_t mask) override;
+	void Remove(int id) override;
+	void Clear() override;
+	const AABB& GetAABB(int id) const override;
+
+	// Append every pair of proxies that share at least one cell, each pair is reported once as (lower id, higher id)
+	void FindPairs(std::vector<std::pair<int, int>>& pairs) override;
+
+	void Query(const AABB& aabb, uint32_t mask, IQueryCallback& callback) const override;
+	bool Raycast(glm::vec2 start, glm::vec2 end, uint32_t mask, int& id, float& fraction, glm::vec2& normal) const override;
+};
@@ -0,0 +1,236 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+#include "SweptAABB.h"
+
+long long SweepAndPrune::PairKey(int a, int b)
+{
+	return (static_cast<long long>(std::min(a, b)) << 32) | static_cast<unsigned int>(std::max(a, b));
+}
+
+bool SweepAndPrune::IsBefore(const Endpoint& a, const Endpoint& b)
+{
+	// On equal values a max goes before a min, touching boxes do not overlap
+	if (a.value != b.value)
+	{
+		return a.value < b.value;
+	}
+	return !a.isMin && b.isMin;
+}
+
+void SweepAndPrune::SetEndpointIndex(int axis, int index)
+{
+	const Endpoint& endpoint = axes[axis][index];
+	proxies[endpoint.id].endpointIndex[axis][endpoint.isMin ? 0 : 1] = index;
+}
+
+void SweepAndPrune::SortAxis(int axis)
+{
+	auto& endpoints = axes[axis];
+
+	for (int i = 1; i < static_cast<int>(endpoints.size()); i++)
+	{
+		for (int j = i; j > 0 && IsBefore(endpoints[j], endpoints[j - 1]); j--)
+		{
+			const Endpoint& moving = endpoints[j];
+			const Endpoint& other = endpoints[j - 1];
+
+			if (moving.isMin && !other.isMin)
+			{
+				// A min passed a max going left, the proxies now overlap on this axis and may overlap on both
+				const Proxy& a = proxies[moving.id];
+				const Proxy& b = proxies[other.id];
+				if (!(a.isStatic && b.isStatic) && a.aabb.Overlaps(b.aabb))
+				{
+					overlappingPairs.insert(PairKey(moving.id, other.id));
+				}
+			}
+			else if (!moving.isMin && other.isMin)
+			{
+				// A max passed a min going left, the proxies stopped overlapping on this axis
+				overlappingPairs.erase(PairKey(moving.id, other.id));
+			}
+
+			std::swap(endpoints[j], endpoints[j - 1]);
+			SetEndpointIndex(axis, j);
+			SetEndpointIndex(axis, j - 1);
+		}
+	}
+}
+
+void SweepAndPrune::ErasePairs(int id)
+{
+	for (auto it = overlappingPairs.begin(); it != overlappingPairs.end();)
+	{
+		const int a = static_cast<int>(*it >> 32);
+		const int b = static_cast<int>(*it & 0xFFFFFFFF);
+		it = (a == id || b == id) ? overlappingPairs.erase(it) : std::next(it);
+	}
+}
+
+void SweepAndPrune::RefreshPairs(int id)
+{
+	ErasePairs(id);
+
+	// The endpoints may not be sorted yet, the next sort only adds or removes the pairs whose overlap changes from here
+	const Proxy& proxy = proxies[id];
+	for (int other = 0; other < static_cast<int>(proxies.size()); other++)
+	{
+		const Proxy& otherProxy = proxies[other];
+		if (other != id && otherProxy.isActive && !(proxy.isStatic && otherProxy.isStatic) && proxy.aabb.Overlaps(otherProxy.aabb))
+		{
+			overlappingPairs.insert(PairKey(id, other));
+		}
+	}
+}
+
+void SweepAndPrune::InsertOrUpdate(int id, const AABB& aabb, bool isStatic, uint32_t layer, uint32_t mask)
+{
+	if (id >= static_cast<int>(proxies.size()))
+	{
+		proxies.resize(id + 1);
+	}
+
+	auto& proxy = proxies[id];
+	const bool hasStaticChanged = proxy.isActive && proxy.isStatic != isStatic;
+	proxy.aabb = aabb;
+	proxy.isStatic = isStatic;
+	proxy.layer = layer;
+	proxy.mask = mask;
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (!proxy.isActive)
+		{
+			// New endpoints go to the end of the lists, the next sort moves them into place and finds their pairs
+			axes[axis].push_back({ aabb.min[axis], id, true });
+			proxy.endpointIndex[axis][0] = static_cast<int>(axes[axis].size()) - 1;
+			axes[axis].push_back({ aabb.max[axis], id, false });
+			proxy.endpointIndex[axis][1] = static_cast<int>(axes[axis].size()) - 1;
+		}
+		else
+		{
+			axes[axis][proxy.endpointIndex[axis][0]].value = aabb.min[axis];
+			axes[axis][proxy.endpointIndex[axis][1]].value = aabb.max[axis];
+		}
+	}
+	proxy.isActive = true;
+
+	if (hasStaticChanged)
+	{
+		RefreshPairs(id);
+	}
+}
+
+void SweepAndPrune::Remove(int id)
+{
+	if (id >= static_cast<int>(proxies.size()) || !proxies[id].isActive)
+	{
+		return;
+	}
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		auto& endpoints = axes[axis];
+		endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(), [id](const Endpoint& endpoint)
+			{
+				return endpoint.id == id;
+			}), endpoints.end());
+
+		for (int i = 0; i < static_cast<int>(endpoints.size()); i++)
+		{
+			SetEndpointIndex(axis, i);
+		}
+	}
+
+	ErasePairs(id);
+	proxies[id].isActive = false;
+}
+
+void SweepAndPrune::Clear()
+{
+	axes[0].clear();
+	axes[1].clear();
+	proxies.clear();
+	overlappingPairs.clear();
+}
+
+const AABB& SweepAndPrune::GetAABB(int id) const
+{
+	return proxies[id].aabb;
+}
+
+void SweepAndPrune::FindPairs(std::vector<std::pair<int, int>>& pairs)
+{
+	SortAxis(0);
+	SortAxis(1);
+
+	for (auto key : overlappingPairs)
+	{
+		const int a = static_cast<int>(key >> 32);
+		const int b = static_cast<int>(key & 0xFFFFFFFF);
+		if (ShouldCollide(proxies[a].layer, proxies[a].mask, proxies[b].layer, proxies[b].mask))
+		{
+			pairs.emplace_back(a, b);
+		}
+	}
+}
+
+void SweepAndPrune::Query(const AABB& aabb, uint32_t mask, IQueryCallback& callback) const
+{
+	// The endpoints are sorted outside of the collision update, proxies starting after the end of the box on x can't overlap it
+	const auto& axis = axes[0];
+	const auto last = std::upper_bound(axis.begin(), axis.end(), aabb.max.x, [](float value, const Endpoint& endpoint)
+		{
+			return value < endpoint.value;
+		});
+
+	for (auto endpoint = axis.begin(); endpoint != last; endpoint++)
+	{
+		if (!endpoint->isMin)
+		{
+			continue;
+		}
+		const Proxy& proxy = proxies[endpoint->id];
+		if ((proxy.layer & mask) != 0 && proxy.aabb.Overlaps(aabb) && !callback.Report(endpoint->id))
+		{
+			return;
+		}
+	}
+}
+
+bool SweepAndPrune::Raycast(glm::vec2 start, glm::vec2 end, uint32_t mask, int& id, float& fraction, glm::vec2& normal) const
+{
+	const glm::vec2 displacement = end - start;
+	const AABB bounds(glm::min(start, end), glm::max(start, end));
+
+	const auto& axis = axes[0];
+	const auto last = std::upper_bound(axis.begin(), axis.end(), bounds.max.x, [](float value, const Endpoint& endpoint)
+		{
+			return value < endpoint.value;
+		});
+
+	bool hasHit = false;
+	for (auto endpoint = axis.begin(); endpoint != last; endpoint++)
+	{
+		if (!endpoint->isMin)
+		{
+			continue;
+		}
+		const Proxy& proxy = proxies[endpoint->id];
+		if ((proxy.layer & mask) == 0 || proxy.aabb.max.x < bounds.min.x)
+		{
+			continue;
+		}
+
+		float hitFraction;
+		glm::vec2 hitNormal;
+		if (RaycastAABB(start, displacement, proxy.aabb, hitFraction, hitNormal) && (!hasHit || hitFraction < fraction))
+		{
+			id = endpoint->id;
+			fraction = hitFraction;
+			normal = hitNormal;
+			hasHit = true;
+		}
+	}
+	return hasHit;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "AABB.h"
+#include "IBroadphase.h"
+#include <vector>
+#include <unordered_set>
+#include <utility>
+
+/*
+* Incremental sweep and prune broadphase
+* The min and max endpoints of every proxy are kept sorted on both axes between frames. Since objects move little from one frame
+* to the next the lists are almost sorted, so insertion sort restores the order in close to linear time. Every swap of a min with
+* a max endpoint means two proxies started or stopped overlapping on that axis, which is when the pair set is updated.
+* Unlike a grid it has no cell size to tune, so it copes well with levels where collider sizes vary a lot.
+* The pair set ignores the layers and masks, they are tested when the pairs are reported so changing them or the layer matrix
+* takes effect on the next FindPairs(). Two static proxies are never paired.
+*/
+class SweepAndPrune : public IBroadphase
+{
+private:
+	struct Endpoint
+	{
+		float value;
+		int id;
+		bool isMin;
+	};
+
+	struct Proxy
+	{
+		AABB aabb;
+		// Position of the endpoints inside the sorted lists
+		// [First index = axis, second index = 0 for min and 1 for max]
+		int endpointIndex[2][2];
+		uint32_t layer = 0;
+		uint32_t mask = 0;
+		bool isStatic = false;
+		bool isActive = false;
+	};
+
+	// Sorted endpoints, [Array index = axis (0 for x, 1 for y)]
+	std::vector<Endpoint> axes[2];
+
+	// [Vector index = proxy id]
+	std::vector<Proxy> proxies;
+
+	// Pairs whose AABB currently overlap, keyed by PairKey()
+	std::unordered_set<long long> overlappingPairs;
+
+	// Forget the pairs of a proxy and test it again against every other one, when it became static or stopped being static
+	void RefreshPairs(int id);
+	void ErasePairs(int id);
+
+	static long long PairKey(int a, int b);
+	static bool IsBefore(const Endpoint& a, const Endpoint& b);
+	void SortAxis(int axis);
+	void SetEndpointIndex(int axis, int index);
+
+public:
+	SweepAndPrune() = default;
+
+	void InsertOrUpdate(int id, const AABB& aabb, bool isStatic, uint32_t layer, uint32_t mask) override;
+	void Remove(int id) override;
+	void Clear() override;
+	const AABB& GetAABB(int id) const override;
+
+	// Sort the endpoints updated since the last call, then append every overlapping pair
+	void FindPairs(std::vector<std::pair<int, int>>& pairs) override;
+
+	void Query(const AABB& aabb, uint32_t mask, IQueryCallback& callback) const override;
+	bool Raycast(glm::vec2 start, glm::vec2 end, uint32_t mask, int& id, float& fraction, glm::vec2& normal) const override;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "AABB.h"
+#include <algorithm>
+
+// Box covering the whole motion of a box that ended at the given AABB after moving by displacement
+inline AABB SweptBounds(const AABB& end, glm::vec2 displacement)
+{
+	return AABB(glm::min(end.min, end.min - displacement), glm::max(end.max, end.max - displacement));
+}
+
+/*
+* Continuous test of box a moving by displacement against a box b at rest (use the relative displacement when both move)
+* Returns true if they touch during the motion, timeOfImpact is then the fraction of the displacement in [0, 1] done before
+* the first contact, and normal the axis of the face of b that was hit. Boxes that already overlap report a time of impact of 0.
+*/
+inline bool SweepAABB(const AABB& a, glm::vec2 displacement, const AABB& b, float& timeOfImpact, glm::vec2& normal)
+{
+	if (a.Overlaps(b))
+	{
+		timeOfImpact = 0.0f;
+		normal = glm::vec2(0, 0);
+		return true;
+	}
+
+	float entry = 0.0f;
+	float exit = 1.0f;
+	glm::vec2 entryNormal(0, 0);
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (displacement[axis] == 0.0f)
+		{
+			// Not moving on this axis, the boxes must already overlap on it
+			if (a.max[axis] <= b.min[axis] || a.min[axis] >= b.max[axis])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const bool isPositive = displacement[axis] > 0.0f;
+		const float axisEntry = ((isPositive ? b.min[axis] - a.max[axis] : b.max[axis] - a.min[axis])) / displacement[axis];
+		const float axisExit = ((isPositive ? b.max[axis] - a.min[axis] : b.min[axis] - a.max[axis])) / displacement[axis];
+
+		if (axisEntry > entry)
+		{
+			entry = axisEntry;
+			entryNormal = glm::vec2(0, 0);
+			entryNormal[axis] = isPositive ? -1.0f : 1.0f;
+		}
+		exit = std::min(exit, axisExit);
+	}
+
+	if (entry >= exit || entry > 1.0f)
+	{
+		return false;
+	}
+
+	timeOfImpact = entry;
+	normal = entryNormal;
+	return true;
+}
+
+// Segment from start to start + displacement against a box, the segment is a box of size 0 swept along it
+inline bool RaycastAABB(glm::vec2 start, glm::vec2 displacement, const AABB& box, float& fraction, glm::vec2& normal)
+{
+	return SweepAABB(AABB(start, start), displacement, box, fraction, normal);
+}
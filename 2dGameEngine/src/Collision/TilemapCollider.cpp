@@ -0,0 +1,140 @@
+#include "TilemapCollider.h"
+#include "../Logger/Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+bool TilemapCollider::LoadSolidTiles(const std::string& filePath, std::vector<int>& solidTiles)
+{
+	std::ifstream file(filePath);
+	if (!file.is_open())
+	{
+		Logger::Err("Error opening the solid tiles " + filePath);
+		return false;
+	}
+
+	solidTiles.clear();
+	std::string line;
+	for (int row = 0; std::getline(file, line); row++)
+	{
+		std::stringstream flags(line);
+		std::string flag;
+		// Same numbering as the .map files, row * 10 + column
+		for (int col = 0; std::getline(flags, flag, ','); col++)
+		{
+			if (std::atoi(flag.c_str()) != 0)
+			{
+				solidTiles.push_back(row * 10 + col);
+			}
+		}
+	}
+
+	Logger::Log("Solid tiles loaded from " + filePath);
+	return true;
+}
+
+void TilemapCollider::Build(const Tilemap& tilemap, const std::vector<int>& solidTiles, uint32_t layer)
+{
+	numCols = tilemap.numCols;
+	numRows = tilemap.numRows;
+	cellSize = tilemap.GetWorldTileSize();
+	this->layer = layer;
+	solidBits.assign((numCols * numRows + 63) / 64, 0);
+
+	for (int row = 0; row < numRows; row++)
+	{
+		for (int col = 0; col < numCols; col++)
+		{
+			const int tile = tilemap.GetTile(col, row);
+			if (std::find(solidTiles.begin(), solidTiles.end(), tile) != solidTiles.end())
+			{
+				SetSolid(col, row, true);
+			}
+		}
+	}
+}
+
+bool TilemapCollider::IsSolid(int col, int row) const
+{
+	if (col < 0 || row < 0 || col >= numCols || row >= numRows)
+	{
+		return false;
+	}
+	const int index = row * numCols + col;
+	return (solidBits[index / 64] >> (index % 64)) & 1;
+}
+
+void TilemapCollider::SetSolid(int col, int row, bool isSolid)
+{
+	if (col < 0 || row < 0 || col >= numCols || row >= numRows)
+	{
+		return;
+	}
+	const int index = row * numCols + col;
+	if (isSolid)
+	{
+		solidBits[index / 64] |= uint64_t(1) << (index % 64);
+	}
+	else
+	{
+		solidBits[index / 64] &= ~(uint64_t(1) << (index % 64));
+	}
+}
+
+bool TilemapCollider::Collide(const AABB& box, TileContact& contact) const
+{
+	// Cells overlapped by the box, touching a cell border does not count
+	const int minCol = std::max(0, static_cast<int>(std::floor(box.min.x / cellSize.x)));
+	const int minRow = std::max(0, static_cast<int>(std::floor(box.min.y / cellSize.y)));
+	const int maxCol = std::min(numCols - 1, static_cast<int>(std::ceil(box.max.x / cellSize.x)) - 1);
+	const int maxRow = std::min(numRows - 1, static_cast<int>(std::ceil(box.max.y / cellSize.y)) - 1);
+
+	bool hasContact = false;
+	for (int row = minRow; row <= maxRow; row++)
+	{
+		for (int col = minCol; col <= maxCol; col++)
+		{
+			if (!IsSolid(col, row))
+			{
+				continue;
+			}
+
+			const glm::vec2 cellMin(col * cellSize.x, row * cellSize.y);
+			const glm::vec2 cellMax = cellMin + cellSize;
+
+			// Push out through the open face needing the smallest move
+			float bestPenetration = INFINITY;
+			glm::vec2 bestNormal(0, 0);
+			auto tryFace = [&](bool isOpen, float penetration, glm::vec2 normal)
+			{
+				if (isOpen && penetration < bestPenetration)
+				{
+					bestPenetration = penetration;
+					bestNormal = normal;
+				}
+			};
+			tryFace(!IsSolid(col - 1, row), box.max.x - cellMin.x, glm::vec2(-1, 0));
+			tryFace(!IsSolid(col + 1, row), cellMax.x - box.min.x, glm::vec2(1, 0));
+			tryFace(!IsSolid(col, row - 1), box.max.y - cellMin.y, glm::vec2(0, -1));
+			tryFace(!IsSolid(col, row + 1), cellMax.y - box.min.y, glm::vec2(0, 1));
+
+			// A cell enclosed by solid cells has no way out on its own, its neighbours give the contact
+			if (bestPenetration == INFINITY)
+			{
+				continue;
+			}
+
+			// Keep the deepest cell, resolving it first also resolves the shallower ones most of the time
+			if (!hasContact || bestPenetration > contact.penetration)
+			{
+				contact.normal = bestNormal;
+				contact.penetration = bestPenetration;
+				contact.col = col;
+				contact.row = row;
+				hasContact = true;
+			}
+		}
+	}
+	return hasContact;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "AABB.h"
+#include "../Tilemap/Tilemap.h"
+#include <vector>
+#include <cstdint>
+#include <string>
+
+// Contact between a box and the solid cells of a TilemapCollider
+struct TileContact
+{
+	// Direction to push the box out of the terrain and by how much
+	glm::vec2 normal = glm::vec2(0, 0);
+	float penetration = 0.0f;
+	// Cell of the deepest contact
+	int col = 0;
+	int row = 0;
+};
+
+/*
+* Solid terrain of a tilemap stored as one bit per cell instead of one collider entity per tile
+* A box is tested only against the cells it overlaps. The map origin is at (0, 0) and everything outside of the map is empty.
+*/
+class TilemapCollider
+{
+private:
+	int numCols = 0;
+	int numRows = 0;
+	glm::vec2 cellSize = glm::vec2(1, 1);
+	std::vector<uint64_t> solidBits;
+	uint32_t layer = 0;
+
+public:
+	TilemapCollider() = default;
+
+	/*
+	* Read the solid tiles of a tileset from a .solid file, the table stored next to the .map files
+	* The file has the layout of the tileset image, one line per row of tiles and one comma separated flag per column, 1 for a solid tile
+	*/
+	static bool LoadSolidTiles(const std::string& filePath, std::vector<int>& solidTiles);
+
+	// Mark the cells whose tile is one of solidTiles as solid
+	void Build(const Tilemap& tilemap, const std::vector<int>& solidTiles, uint32_t layer);
+
+	bool IsSolid(int col, int row) const;
+	void SetSolid(int col, int row, bool isSolid);
+
+	uint32_t GetLayer() const
+	{
+		return layer;
+	}
+
+	size_t GetMemorySize() const
+	{
+		return solidBits.size() * sizeof(uint64_t);
+	}
+
+	/*
+	* Test the box against the solid cells it overlaps, returns true if it penetrates the terrain
+	* Faces shared by two solid cells are ignored, so a box sliding along a wall is never pushed sideways by the seams between tiles
+	*/
+	bool Collide(const AABB& box, TileContact& contact) const;
+};
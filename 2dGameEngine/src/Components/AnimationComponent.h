@@ -8,13 +8,14 @@ struct AnimationComponent
 	int currentFrame;
 	int frameSpeedRate;
 	bool isLoop;
-	int startTime;
+	// Game time in milliseconds, set by the AnimationSystem when the entity is added to it
+	Uint64 startTime;
 
 	AnimationComponent(int numFrames = 1, int frameSpeedRate = 1, bool isLoop = true) :
 		numFrames(numFrames),
 		currentFrame(1),
 		frameSpeedRate(frameSpeedRate),
 		isLoop(isLoop),
-		startTime(SDL_GetTicks())
+		startTime(0)
 	{}
 };
\ No newline at end of file
@@ -1,14 +1,22 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <cstdint>
 
 struct BoxColliderComponent
 {
 	int width;
 	int height;
 	glm::vec2 offset;
+	// Static colliders never move, the broadphase never tests them against each other
+	bool isStatic;
+	// Bitfield of the collision layers of the collider and of the layers it collides with, the CollisionSystem layer matrix further restricts the mask
+	uint32_t layer;
+	uint32_t mask;
+	// Continuous colliders are swept along their RigidBodyComponent velocity so fast movers cannot tunnel through thin colliders
+	bool isContinuous;
 
-	BoxColliderComponent(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0, 0)) 
-		: width(width), height(height), offset(offset) 
+	BoxColliderComponent(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0, 0), bool isStatic = false, uint32_t layer = 1, uint32_t mask = 0xFFFFFFFF, bool isContinuous = false) 
+		: width(width), height(height), offset(offset), isStatic(isStatic), layer(layer), mask(mask), isContinuous(isContinuous)
 	{}
 };
\ No newline at end of file
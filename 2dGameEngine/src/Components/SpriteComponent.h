@@ -1,24 +1,29 @@
 #pragma once
 
 #include <glm/glm.hpp>
-#include <string>
 #include <SDL.h>
+#include "../AssetStore/TextureHandle.h"
 
 struct SpriteComponent
 {
-	std::string assetId;
+	TextureHandle texture;
 	int width;
 	int height;
 	int zIndex;
 	bool isFixed;
 	SDL_Rect srcRect;
+	// Promise that the transform never changes, the RenderSystem then bins the sprite once instead of testing it every frame
+	// A static sprite that is moved anyway must be passed to RenderSystem::MoveStaticSprite()
+	bool isStatic;
 
-	SpriteComponent(std::string assetId = "", int width = 0, int height = 0, int zIndex = 0, bool isFixed = false, int srcRectX = 0, int srcRectY = 0) :
-		assetId(assetId), 
+	SpriteComponent(TextureHandle texture = INVALID_TEXTURE_HANDLE, int width = 0, int height = 0, int zIndex = 0, bool isFixed = false, int srcRectX = 0, int srcRectY = 0,
+		bool isStatic = false) :
+		texture(texture), 
 		width(width), 
 		height(height), 
 		zIndex(zIndex),
 		isFixed(isFixed),
-		srcRect({srcRectX, srcRectY, width, height})
+		srcRect({srcRectX, srcRectY, width, height}),
+		isStatic(isStatic)
 	{}
 };
\ No newline at end of file
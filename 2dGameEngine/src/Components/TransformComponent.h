@@ -8,10 +8,16 @@ struct TransformComponent
 	glm::vec2 scale;
 	double rotation;
 
+	// State at the start of the current simulation tick, rendering interpolates from it to the current state
+	glm::vec2 previousPosition;
+	double previousRotation;
+
 	TransformComponent(glm::vec2 position = glm::vec2(0,0), glm::vec2 scale = glm::vec2(1, 1), double rotation = 0.0)
 	{
 		this->position = position;
 		this->scale = scale;
 		this->rotation = rotation;
+		this->previousPosition = position;
+		this->previousRotation = rotation;
 	}
 };
\ No newline at end of file
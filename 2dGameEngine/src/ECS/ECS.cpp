@@ -1,5 +1,6 @@
 #include "ECS.h"
 #include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
 
 // Allocating memory for the static variable
 int IComponent::nextId = 0;
@@ -18,17 +19,25 @@ void Entity::Kill()
 void System::AddEntityToSystem(Entity entity)
 {
 	entities.push_back(entity);
+	OnEntityAdded(entity);
 }
 
 void System::RemoveEntityFromSystem(Entity entity)
 {
-	entities.erase(std::remove_if(entities.begin(), entities.end(), [&entity](Entity other)
+	auto it = std::remove_if(entities.begin(), entities.end(), [&entity](Entity other)
 		{
 			return entity == other;
-		}), entities.end());
+		});
+
+	// Killed entities are removed from every system, only notify the systems that actually had it
+	if (it != entities.end())
+	{
+		entities.erase(it, entities.end());
+		OnEntityRemoved(entity);
+	}
 }
 
-std::vector<Entity> System::GetSystemEntities() const
+const std::vector<Entity>& System::GetSystemEntities() const
 {
 	return entities;
 }
@@ -74,6 +83,26 @@ void Registry::KillEntity(Entity entity)
 	Logger::Log("Entity " + std::to_string(entity.GetId()) + " was killed");
 }
 
+int Registry::GetNumEntities() const
+{
+	return numEntities - static_cast<int>(freeIds.size());
+}
+
+void Registry::GetPoolStats(std::vector<ComponentPoolStats>& stats) const
+{
+	stats.clear();
+	for (size_t componentId = 0; componentId < componentPools.size(); componentId++)
+	{
+		const auto& pool = componentPools[componentId];
+		if (!pool)
+		{
+			continue;
+		}
+
+		stats.push_back({ pool->GetComponentName(), componentCounts[componentId], pool->GetSize(), pool->GetMemorySize() });
+	}
+}
+
 void Registry::AddEntityToSystems(Entity entity)
 {
 	const auto entityId = entity.GetId();
@@ -103,6 +132,7 @@ void Registry::RemoveEntityFromSystem(Entity entity)
 
 void Registry::Update()
 {
+	PROFILE_SCOPE("Registry::Update");
 	// Processing the entities that are waiting to be created to the active System
 	for (auto entity : entitiesToBeAdded)
 	{
@@ -116,7 +146,15 @@ void Registry::Update()
 	{
 		RemoveEntityFromSystem(entity);
 
-		entityComponentSignatures[entity.GetId()].reset();
+		Signature& signature = entityComponentSignatures[entity.GetId()];
+		for (size_t componentId = 0; componentId < componentCounts.size(); componentId++)
+		{
+			if (signature.test(componentId))
+			{
+				componentCounts[componentId]--;
+			}
+		}
+		signature.reset();
 		
 		// Make the entity id available to be reused
 		freeIds.push_back(entity.GetId());
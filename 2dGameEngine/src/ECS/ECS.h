@@ -40,6 +40,7 @@ private:
 	int id;
 
 public:
+	Entity(): id(-1), registry(nullptr) {}
 	Entity(int id): id(id) {}
 	Entity(const Entity& entity) = default;
 	void Kill();
@@ -70,14 +71,21 @@ private:
 	std::vector<Entity> entities;
 	
 public:
+	virtual ~System() = default;
+
 	void AddEntityToSystem(Entity entity);
 	void RemoveEntityFromSystem(Entity entity);
-	std::vector<Entity> GetSystemEntities() const;
+	const std::vector<Entity>& GetSystemEntities() const;
 	const Signature& GetComponentSignature() const;
 
 	// Define the component type T that the entities must have to be considered by the system
 	template <typename TComponent>
 	void RequireComponent();
+
+protected:
+	// Called once an entity starts or stops being processed by the system, systems that keep their own data structures per entity override these
+	virtual void OnEntityAdded(Entity entity) {}
+	virtual void OnEntityRemoved(Entity entity) {}
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -87,6 +95,11 @@ class IPool
 {
 public:
 	virtual ~IPool() {}
+
+	virtual int GetSize() const = 0;
+	// Bytes allocated by the pool
+	virtual size_t GetMemorySize() const = 0;
+	virtual const char* GetComponentName() const = 0;
 };
 
 /* Pool */
@@ -109,10 +122,21 @@ public:
 		return data.empty();
 	}
 
-	int GetSize() const
+	int GetSize() const override
 	{
 		return data.size();
 	}
+
+	size_t GetMemorySize() const override
+	{
+		return data.capacity() * sizeof(T);
+	}
+
+	const char* GetComponentName() const override
+	{
+		return typeid(T).name();
+	}
+
 	void Resize(int n)
 	{
 		data.resize(n);
@@ -141,6 +165,16 @@ public:
 };
 
 
+// Occupancy of one component pool
+struct ComponentPoolStats
+{
+	const char* componentName;
+	// Entities having the component, out of the size slots of the pool
+	int numComponents;
+	int size;
+	size_t memorySize;
+};
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 /* Registry */
 /* The Registry manages the creation and destruction of entities, add systems and components */
@@ -154,6 +188,10 @@ private:
 	// [Pool index = entity id]
 	std::vector<std::shared_ptr<IPool>> componentPools;
 
+	// Number of entities having each component, kept up to date so the stats never scan the signatures
+	// [Vector index = component type id]
+	std::vector<int> componentCounts;
+
 	// Vector of component signatures per entity, saying which componnet is turned on for a given entity
 	// [Vector index = entity id]
 	std::vector<Signature> entityComponentSignatures;
@@ -186,6 +224,8 @@ public:
 	// Entity Management
 	Entity CreateEntity();
 	void KillEntity(Entity entity);
+	// Entities alive, including the ones waiting to be added in the next Update()
+	int GetNumEntities() const;
 
 	// Component management
 	template <typename TComponent, typename ...TArgs> void AddComponent(Entity entity, TArgs&& ...args);
@@ -202,6 +242,9 @@ public:
 	// Add and remove entities fromm their system
 	void AddEntityToSystems(Entity entity);
 	void RemoveEntityFromSystem(Entity entity);
+
+	// Fill stats with one entry per component pool
+	void GetPoolStats(std::vector<ComponentPoolStats>& stats) const;
 };
 
 template <typename TComponent>
@@ -251,6 +294,7 @@ void Registry::AddComponent(Entity entity, TArgs&& ...args)
 	if (componentId >= componentPools.size())
 	{
 		componentPools.resize(componentId + 1, nullptr);
+		componentCounts.resize(componentId + 1, 0);
 	}
 
 	// if the required pool is not there, add a new pool for the component
@@ -271,6 +315,11 @@ void Registry::AddComponent(Entity entity, TArgs&& ...args)
 	// Finally we can create the component and set it's component bitset
 	TComponent newComponent(std::forward<TArgs>(args)...);
 	componentPool->Set(entityId, newComponent);
+	// Adding a component the entity already has replaces it
+	if (!entityComponentSignatures[entityId].test(componentId))
+	{
+		componentCounts[componentId]++;
+	}
 	entityComponentSignatures[entityId].set(componentId);
 
 	Logger::Log("Component id = " + std::to_string(componentId) + " was added to entity id " + std::to_string(entityId));
@@ -281,6 +330,10 @@ void Registry::RemoveComponent(Entity entity)
 {
 	const auto componentId = Component<TComponent>::GetId();
 	const auto entityId = entity.GetId();
+	if (entityComponentSignatures[entityId].test(componentId))
+	{
+		componentCounts[componentId]--;
+	}
 	entityComponentSignatures[entityId].set(componentId, false);
 
 	Logger::Log("Component id = " + std::to_string(componentId) + " was removed to entity id " + std::to_string(entityId));
@@ -2,10 +2,76 @@
 
 #include "../Logger/Logger.h"
 #include "../EventBus/Event.h"
+#include "../Profiler/Profiler.h"
 #include <map>
 #include <typeindex>
 #include <list>
 #include <memory>
+#include <array>
+#include <chrono>
+#include <ostream>
+
+// Set EVENTBUS_STATS to 0 to compile the event statistics out completely, release builds leave them off unless it is defined
+#ifndef EVENTBUS_STATS
+#ifdef NDEBUG
+#define EVENTBUS_STATS 0
+#else
+#define EVENTBUS_STATS 1
+#endif
+#endif
+
+#if EVENTBUS_STATS
+// Handler latency histogram buckets: bucket i counts calls faster than 4^i microseconds, the last bucket counts everything slower
+const int EVENT_LATENCY_BUCKETS = 8;
+
+/*
+* Counters for one handler, a handler is identified by the event type and the type of the subscribing owner
+*/
+struct EventHandlerStats
+{
+	const char* ownerName = "";
+	unsigned int invocations = 0;
+	long long totalNanoseconds = 0;
+	long long maxNanoseconds = 0;
+	std::array<unsigned int, EVENT_LATENCY_BUCKETS> latencyHistogram{};
+
+	void Record(long long nanoseconds)
+	{
+		invocations++;
+		totalNanoseconds += nanoseconds;
+		maxNanoseconds = nanoseconds > maxNanoseconds ? nanoseconds : maxNanoseconds;
+
+		int bucket = 0;
+		long long bucketLimit = 1000;
+		while (bucket < EVENT_LATENCY_BUCKETS - 1 && nanoseconds >= bucketLimit)
+		{
+			bucketLimit *= 4;
+			bucket++;
+		}
+		latencyHistogram[bucket]++;
+	}
+
+	void Reset()
+	{
+		invocations = 0;
+		totalNanoseconds = 0;
+		maxNanoseconds = 0;
+		latencyHistogram.fill(0);
+	}
+};
+
+/*
+* Counters for one event type
+* [Map key = owner type of the subscriber]
+*/
+struct EventTypeStats
+{
+	const char* eventName = "";
+	unsigned int emitCount = 0;
+	unsigned int handlerInvocations = 0;
+	std::map<std::type_index, EventHandlerStats> handlers;
+};
+#endif
 
 class IEventCallback
 {
@@ -18,6 +84,11 @@ public:
 	{
 		Call(e);
 	}
+
+#if EVENTBUS_STATS
+	// Points into the EventBus stats map, which outlives the callback
+	EventHandlerStats* stats = nullptr;
+#endif
 };
 
 template <typename TOwner, typename TEvent>
@@ -53,10 +124,18 @@ class EventBus
 private:
 	/*
 	* This map will contain event as key and a list of callback functions as Value
-	* Example: <Key, Value> = <CollisionEvent, [subscriberCallback*, subscriberCallback*] 
+	* Example: <Key, Value> = <CollisionEnterEvent, [subscriberCallback*, subscriberCallback*] 
 	*/
 	std::map<std::type_index, std::unique_ptr<HandlerList>> subscribers;
 
+#if EVENTBUS_STATS
+	/*
+	* Statistics survive Reset() so they cover a whole frame even though the subscribers are recreated every frame
+	* Entries are only added the first time an event type or handler is seen, reading and resetting them never allocates
+	*/
+	std::map<std::type_index, EventTypeStats> stats;
+#endif
+
 public:
 	EventBus()
 	{
@@ -77,7 +156,7 @@ public:
 	/*
 	* Subscribe to an event type <T>
 	* In our implementation, a listener subscribe to an event
-	* Example: eventBus->SubscribeToEvent<CollisionEvent>(this, &Game::OnCollision);
+	* Example: eventBus->SubscribeToEvent<CollisionEnterEvent>(this, &Game::OnCollision);
 	*/
 	template <typename TEvent, typename TOwner>
 	void SubscribeToEvent(TOwner* ownerInstance, void (TOwner::* callbackFunction)(TEvent&))
@@ -88,6 +167,14 @@ public:
 		}
 		auto subscriber = std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFunction);
 
+#if EVENTBUS_STATS
+		auto& typeStats = stats[typeid(TEvent)];
+		typeStats.eventName = typeid(TEvent).name();
+		auto& handlerStats = typeStats.handlers[typeid(TOwner)];
+		handlerStats.ownerName = typeid(TOwner).name();
+		subscriber->stats = &handlerStats;
+#endif
+
 		// Since the subscriber is a unique pointer, we need to use std::move when we want to push it to a map. We use std::move to change the ownership of an object from one unique_ptr to another unique_ptr.
 		subscribers[typeid(TEvent)]->push_back(std::move(subscriber));
 	}
@@ -95,20 +182,103 @@ public:
 	/*
 	* Emit an event type <T>
 	* In our implementation, as soon as something emits an event we go ahead and execute all the listener callback functions
-	* Example: eventBus->EmitEvent<CollisionEvent>(player, enemy);
+	* Example: eventBus->EmitEvent<CollisionEnterEvent>(player, enemy);
 	*/
 	template<typename TEvent, typename ...TArgs>
 	void EmitEvent(TArgs&& ...args)
 	{
+		PROFILE_SCOPE("EventBus::EmitEvent");
 		auto handlers = subscribers[typeid(TEvent)].get();
+
+#if EVENTBUS_STATS
+		auto& typeStats = stats[typeid(TEvent)];
+		typeStats.eventName = typeid(TEvent).name();
+		typeStats.emitCount++;
+#endif
+
 		if (handlers)
 		{
 			for (auto it = handlers->begin(); it != handlers->end(); it++)
 			{
 				auto handler = it->get();
 				TEvent event(std:: forward<TArgs>(args)...);
+#if EVENTBUS_STATS
+				auto start = std::chrono::steady_clock::now();
+				handler->Execute(event);
+				auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+				typeStats.handlerInvocations++;
+				handler->stats->Record(elapsed.count());
+#else
 				handler->Execute(event);
+#endif
+			}
+		}
+	}
+
+#if EVENTBUS_STATS
+	/*
+	* Read the counters of the current frame
+	* [Map key = event type]
+	*/
+	const std::map<std::type_index, EventTypeStats>& GetStats() const
+	{
+		return stats;
+	}
+
+	// Zero all the counters, called once per frame by the game loop
+	void ResetStats()
+	{
+		for (auto& typeStats : stats)
+		{
+			typeStats.second.emitCount = 0;
+			typeStats.second.handlerInvocations = 0;
+			for (auto& handlerStats : typeStats.second.handlers)
+			{
+				handlerStats.second.Reset();
+			}
+		}
+	}
+
+	/*
+	* Write the counters as CSV, one line per handler (or per event type when nothing subscribed to it)
+	* Columns: event, handler, emits, invocations, total_us, max_us, followed by the latency histogram buckets
+	*/
+	void ExportStats(std::ostream& stream) const
+	{
+		stream << "event,handler,emits,invocations,total_us,max_us";
+		for (int i = 0; i < EVENT_LATENCY_BUCKETS; i++)
+		{
+			stream << ",bucket" << i;
+		}
+		stream << "\n";
+
+		for (const auto& typeStats : stats)
+		{
+			const auto& eventStats = typeStats.second;
+			if (eventStats.handlers.empty())
+			{
+				stream << eventStats.eventName << ",," << eventStats.emitCount << ",0,0,0";
+				for (int i = 0; i < EVENT_LATENCY_BUCKETS; i++)
+				{
+					stream << ",0";
+				}
+				stream << "\n";
+				continue;
+			}
+
+			for (const auto& handler : eventStats.handlers)
+			{
+				const auto& handlerStats = handler.second;
+				stream << eventStats.eventName << "," << handlerStats.ownerName << "," << eventStats.emitCount << "," << handlerStats.invocations << ","
+					<< handlerStats.totalNanoseconds / 1000.0 << "," << handlerStats.maxNanoseconds / 1000.0;
+				for (auto count : handlerStats.latencyHistogram)
+				{
+					stream << "," << count;
+				}
+				stream << "\n";
 			}
 		}
 	}
+#endif
 };
\ No newline at end of file
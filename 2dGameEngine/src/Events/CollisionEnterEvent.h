@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../EventBus/Event.h"
+#include <glm/glm.hpp>
+
+/*
+* Emitted on the first frame two colliders overlap
+* For continuous colliders timeOfImpact is the fraction of the frame movement done before the contact and normal the hit face of b,
+* discrete contacts are only found at the end of the frame so they have a time of impact of 1 and no normal
+*/
+class CollisionEnterEvent: public Event
+{
+public:
+	Entity a;
+	Entity b;
+	float timeOfImpact;
+	glm::vec2 normal;
+	CollisionEnterEvent(Entity a, Entity b, float timeOfImpact = 1.0f, glm::vec2 normal = glm::vec2(0, 0)) : a(a), b(b), timeOfImpact(timeOfImpact), normal(normal)
+	{
+
+	}
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../EventBus/Event.h"
+
+// Emitted on the first frame two colliders stopped overlapping, or when one of them is removed, before its components are released
+class CollisionExitEvent: public Event
+{
+public:
+	Entity a;
+	Entity b;
+	CollisionExitEvent(Entity a, Entity b) : a(a), b(b)
+	{
+
+	}
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../EventBus/Event.h"
+
+// Emitted on every following frame the colliders still overlap, only when the CollisionSystem has stay events enabled
+class CollisionStayEvent: public Event
+{
+public:
+	Entity a;
+	Entity b;
+	CollisionStayEvent(Entity a, Entity b) : a(a), b(b)
+	{
+
+	}
+};
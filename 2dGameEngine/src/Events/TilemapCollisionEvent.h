@@ -0,0 +1,18 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../EventBus/Event.h"
+#include <glm/glm.hpp>
+
+// Emitted every frame a collider penetrates the solid cells of the tilemap, moving it by normal * penetration resolves the contact
+class TilemapCollisionEvent: public Event
+{
+public:
+	Entity entity;
+	glm::vec2 normal;
+	float penetration;
+	TilemapCollisionEvent(Entity entity, glm::vec2 normal, float penetration) : entity(entity), normal(normal), penetration(penetration)
+	{
+
+	}
+};
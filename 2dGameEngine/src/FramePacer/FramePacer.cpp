@@ -0,0 +1,113 @@
+#include "FramePacer.h"
+#include "../Profiler/Profiler.h"
+#include <algorithm>
+#include <thread>
+
+FramePacer::FramePacer(double targetFrameRate)
+{
+	SetTargetFrameRate(targetFrameRate);
+	frameTimes.reserve(WINDOW_SIZE);
+	sortedFrameTimes.reserve(WINDOW_SIZE);
+}
+
+void FramePacer::SetTargetFrameRate(double targetFrameRate)
+{
+	period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFrameRate));
+	isStarted = false;
+}
+
+void FramePacer::WaitForNextFrame()
+{
+	PROFILE_SCOPE("FramePacer::WaitForNextFrame");
+	if (!isStarted)
+	{
+		isStarted = true;
+		previousFrame = Clock::now();
+		deadline = previousFrame + period;
+		return;
+	}
+
+	// Hybrid wait, sleep while the deadline is far and spin the last stretch
+	Clock::time_point now = Clock::now();
+	while (deadline - now > SPIN_THRESHOLD)
+	{
+		std::this_thread::sleep_for(deadline - now - SPIN_THRESHOLD);
+		now = Clock::now();
+	}
+	while (now < deadline)
+	{
+		std::this_thread::yield();
+		now = Clock::now();
+	}
+
+	RecordFrame(now);
+
+	// A frame late by more than a period missed at least one deadline, do not try to catch up with a burst of short frames
+	deadline += period;
+	if (now > deadline)
+	{
+		droppedFrames += static_cast<int>((now - deadline) / period) + 1;
+		deadline = now + period;
+	}
+}
+
+void FramePacer::RecordFrame(Clock::time_point now)
+{
+	const double frameTime = std::chrono::duration<double, std::milli>(now - previousFrame).count();
+	previousFrame = now;
+
+	if (static_cast<int>(frameTimes.size()) < WINDOW_SIZE)
+	{
+		frameTimes.push_back(frameTime);
+	}
+	else
+	{
+		frameTimes[nextFrameTime] = frameTime;
+	}
+	nextFrameTime = (nextFrameTime + 1) % WINDOW_SIZE;
+}
+
+int FramePacer::GetNumFrameTimes() const
+{
+	return static_cast<int>(frameTimes.size());
+}
+
+double FramePacer::GetFrameTime(int index) const
+{
+	// Until the window is full nextFrameTime is past the end and the oldest frame is the first one
+	const int oldest = static_cast<int>(frameTimes.size()) < WINDOW_SIZE ? 0 : nextFrameTime;
+	return frameTimes[(oldest + index) % frameTimes.size()];
+}
+
+FrameTimeStats FramePacer::GetStats() const
+{
+	FrameTimeStats stats;
+	stats.droppedFrames = droppedFrames;
+	stats.numFrames = static_cast<int>(frameTimes.size());
+	if (frameTimes.empty())
+	{
+		return stats;
+	}
+
+	sortedFrameTimes.assign(frameTimes.begin(), frameTimes.end());
+	std::sort(sortedFrameTimes.begin(), sortedFrameTimes.end());
+
+	// Nearest rank percentiles
+	auto percentile = [this](double fraction)
+	{
+		const size_t rank = static_cast<size_t>(fraction * (sortedFrameTimes.size() - 1) + 0.5);
+		return sortedFrameTimes[rank];
+	};
+
+	double total = 0.0;
+	for (double frameTime : sortedFrameTimes)
+	{
+		total += frameTime;
+	}
+	stats.average = total / sortedFrameTimes.size();
+	stats.p50 = percentile(0.50);
+	stats.p95 = percentile(0.95);
+	stats.p99 = percentile(0.99);
+	stats.max = sortedFrameTimes.back();
+	return stats;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+// Frame times over the rolling window of the FramePacer, in milliseconds
+struct FrameTimeStats
+{
+	double average = 0.0;
+	double p50 = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+	int numFrames = 0;
+	// Frames that missed their deadline by at least a whole frame since the pacer started
+	int droppedFrames = 0;
+};
+
+/*
+* Paces the main loop to a target frame rate with frame deadlines on the steady clock
+* The OS sleep can overshoot by a scheduler quantum, so the pacer sleeps until SPIN_THRESHOLD before the deadline and spins
+* for the rest. Deadlines advance by exactly one period, so an early or late frame does not shift the following ones,
+* unless the loop fell more than a frame behind, then the deadlines restart from now and the missed frames are counted as dropped.
+*/
+class FramePacer
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	// Sleeping is left to the OS only while the deadline is further than this
+	static constexpr std::chrono::microseconds SPIN_THRESHOLD = std::chrono::microseconds(2000);
+	// Number of frames in the rolling window of the statistics, a few seconds at 60 Hz
+	static const int WINDOW_SIZE = 240;
+
+	Clock::duration period;
+	Clock::time_point deadline;
+	Clock::time_point previousFrame;
+	bool isStarted = false;
+
+	// Ring buffer of the last frame times in milliseconds
+	std::vector<double> frameTimes;
+	int nextFrameTime = 0;
+	int droppedFrames = 0;
+
+	// Scratch of GetStats(), kept to avoid allocating
+	mutable std::vector<double> sortedFrameTimes;
+
+	void RecordFrame(Clock::time_point now);
+
+public:
+	FramePacer(double targetFrameRate);
+
+	void SetTargetFrameRate(double targetFrameRate);
+
+	// Wait for the deadline of the next frame, then record the time of the frame that just ended
+	void WaitForNextFrame();
+
+	FrameTimeStats GetStats() const;
+
+	// Frame times of the rolling window in milliseconds, index 0 is the oldest
+	int GetNumFrameTimes() const;
+	double GetFrameTime(int index) const;
+};
@@ -16,12 +16,19 @@
 #include "../Systems/RenderColliderSystem.h"
 #include "../Systems/DamageSystem.h"
 #include "../Systems/KeyboardControlSystem.h"
+#include "../Systems/TerrainResponseSystem.h"
 #include "../Systems/CameraMovementSystem.h"
+#include "../Tilemap/Tilemap.h"
+#include "../Tilemap/TilemapRenderer.h"
+#include "../Renderer/FrameRenderer.h"
+#include "../Profiler/Profiler.h"
+#include "../Hud/PerformanceHud.h"
 #include <SDL.h>
 #include <SDL_image.h>
 #include <glm/glm.hpp>
 #include <iostream>
 #include <fstream>
+#include <cmath>
 #include "../Events/KeyPressedEvent.h"
 
 int Game::windowWidth;
@@ -29,13 +36,18 @@ int Game::windowHeight;
 int Game::mapWidth;
 int Game::mapHeight;
 
-Game::Game()
+Game::Game(const GameConfig& config) : config(config)
 {
 	isRunning = false;
 	isDebug = false;
+	window = nullptr;
+	renderer = nullptr;
 	registry = std::make_unique<Registry>();
 	assetStore = std::make_unique<AssetStore>();
 	eventBus = std::make_unique<EventBus>();
+	// Servers run hundreds of instances per machine, worker threads in each of them would only compete with each other
+	threadPool = config.isServer ? std::make_unique<ThreadPool>(0) : std::make_unique<ThreadPool>();
+	framePacer = std::make_unique<FramePacer>(config.isServer ? config.tickRate : (config.frameRate > 0 ? config.frameRate : FPS));
 	Logger::Log("Game constructor called");
 }
 
@@ -46,40 +58,106 @@ Game::~Game()
 
 void Game::Initialize()
 {
-	if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
+	// The dummy video driver needs no display, and a headless run has no use for audio or controllers
+	if (config.isHeadless)
+	{
+		SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+	}
+	// A server does not even initialize the video, the events are kept to quit cleanly on SIGINT
+	Uint32 subsystems = SDL_INIT_EVERYTHING;
+	if (config.isServer)
+	{
+		subsystems = SDL_INIT_TIMER | SDL_INIT_EVENTS;
+	}
+	else if (config.isHeadless)
+	{
+		subsystems = SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_EVENTS;
+	}
+	if (SDL_Init(subsystems) != 0)
 	{
 		Logger::Err("Error initializeing SDL.");
 		return;
 	}
-	SDL_DisplayMode displayMode;
-	SDL_GetCurrentDisplayMode(0, &displayMode);
-	windowWidth = displayMode.w;
-	windowHeight = displayMode.h;
-
-	window = SDL_CreateWindow(
-		NULL,
-		SDL_WINDOWPOS_CENTERED,
-		SDL_WINDOWPOS_CENTERED,
-		windowWidth,
-		windowHeight,
-		SDL_WINDOW_BORDERLESS
-		);
-	if (!window)
+
+	if (config.isServer)
 	{
-		Logger::Err("Error creating SDL window.");
-		return;
+		// No window and no renderer, the size only sets the camera the simulation still moves
+		windowWidth = config.windowWidth > 0 ? config.windowWidth : 1280;
+		windowHeight = config.windowHeight > 0 ? config.windowHeight : 720;
+		Logger::Log("Running the simulation only at " + std::to_string(config.tickRate) + " ticks per second" + (config.isFast ? ", as fast as possible" : ""));
 	}
-	renderer = SDL_CreateRenderer(
-		window, 
-		-1,
-		SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
-	);
-	if (!renderer)
+	else if (config.isHeadless)
 	{
-		Logger::Err("Error creating SDL renderer.");
-		return;
+		windowWidth = config.windowWidth > 0 ? config.windowWidth : 1280;
+		windowHeight = config.windowHeight > 0 ? config.windowHeight : 720;
+
+		// Render with the software renderer into an offscreen surface, so nothing depends on a GPU or a display
+		window = nullptr;
+		offscreenSurface = SDL_CreateRGBSurfaceWithFormat(0, windowWidth, windowHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+		if (!offscreenSurface)
+		{
+			Logger::Err("Error creating the offscreen surface.");
+			return;
+		}
+		renderer = SDL_CreateSoftwareRenderer(offscreenSurface);
+		if (!renderer)
+		{
+			Logger::Err("Error creating SDL software renderer.");
+			return;
+		}
+		Logger::Log("Running headless at " + std::to_string(windowWidth) + "x" + std::to_string(windowHeight));
+	}
+	else
+	{
+		// Fullscreen at the display resolution unless a resolution was given
+		const bool isFullscreen = config.windowWidth <= 0 || config.windowHeight <= 0;
+		SDL_DisplayMode displayMode;
+		if (SDL_GetCurrentDisplayMode(0, &displayMode) != 0)
+		{
+			displayMode.w = 1280;
+			displayMode.h = 720;
+			displayMode.refresh_rate = 0;
+		}
+		windowWidth = isFullscreen ? displayMode.w : config.windowWidth;
+		windowHeight = isFullscreen ? displayMode.h : config.windowHeight;
+
+		// Pace the frames at the refresh rate of the display, a 144 Hz display is not held back to 60 frames per second
+		int frameRate = config.frameRate;
+		if (frameRate <= 0)
+		{
+			frameRate = displayMode.refresh_rate > 0 ? displayMode.refresh_rate : FPS;
+		}
+		framePacer->SetTargetFrameRate(frameRate);
+		Logger::Log("Running at " + std::to_string(frameRate) + " frames per second");
+
+		window = SDL_CreateWindow(
+			NULL,
+			SDL_WINDOWPOS_CENTERED,
+			SDL_WINDOWPOS_CENTERED,
+			windowWidth,
+			windowHeight,
+			SDL_WINDOW_BORDERLESS
+			);
+		if (!window)
+		{
+			Logger::Err("Error creating SDL window.");
+			return;
+		}
+		renderer = SDL_CreateRenderer(
+			window, 
+			-1,
+			SDL_RENDERER_ACCELERATED | (config.isVsync ? SDL_RENDERER_PRESENTVSYNC : 0)
+		);
+		if (!renderer)
+		{
+			Logger::Err("Error creating SDL renderer.");
+			return;
+		}
+		if (isFullscreen)
+		{
+			SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
+		}
 	}
-	SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
 
 	// Initialize the camera view with the entire screen area
 	camera.x = 0;
@@ -90,8 +168,10 @@ void Game::Initialize()
 	isRunning = true;
 }
 
+// Pumps the SDL events, only ever called from the main thread that owns the window and the renderer
 void Game::ProcessInput()
 {
+	PROFILE_SCOPE("Game::ProcessInput");
 	SDL_Event sdlEvent;
 	while (SDL_PollEvent(&sdlEvent))
 	{
@@ -100,40 +180,107 @@ void Game::ProcessInput()
 		case SDL_QUIT:
 			isRunning = false;
 			break;
+		case SDL_RENDER_TARGETS_RESET:
+			// The baked tilemap chunks were lost with the render targets
+			if (frameRenderer)
+			{
+				frameRenderer->InvalidateTargets();
+			}
+			break;
+		case SDL_RENDER_DEVICE_RESET:
+			// Every texture was lost with the device
+			if (frameRenderer)
+			{
+				frameRenderer->InvalidateDevice();
+			}
+			if (performanceHud)
+			{
+				Logger::Err("The HUD font texture is not restored after a device reset, restart to see the HUD again");
+			}
+			break;
 		case SDL_KEYDOWN:
 			if (sdlEvent.key.keysym.sym == SDLK_ESCAPE)
 			{
 				isRunning = false;
 			}
-			if (sdlEvent.key.keysym.sym == SDLK_b)
 			{
-				isDebug = !isDebug;
+				// The simulation handles the keys at the start of its next frame
+				std::lock_guard<std::mutex> lock(inputMutex);
+				pendingKeys.push_back(sdlEvent.key.keysym.sym);
 			}
-			eventBus->EmitEvent<KeyPressedEvent>(sdlEvent.key.keysym.sym);
 			break;
 		}
 	}
 
 }
 
+// Handles the keys queued by ProcessInput() on the simulation side
+void Game::ProcessKeys()
+{
+	{
+		std::lock_guard<std::mutex> lock(inputMutex);
+		std::swap(pendingKeys, keysToProcess);
+	}
+
+	for (SDL_Keycode key : keysToProcess)
+	{
+		if (key == SDLK_b)
+		{
+			isDebug = !isDebug;
+		}
+#if PROFILER_ENABLED
+		if (key == SDLK_F2)
+		{
+			Profiler::CaptureFrames(PROFILE_CAPTURE_FRAMES, "profile.json");
+		}
+#endif
+#if EVENTBUS_STATS
+		if (key == SDLK_F3)
+		{
+			isEventStatsRequested = true;
+		}
+#endif
+		eventBus->EmitEvent<KeyPressedEvent>(key);
+	}
+	keysToProcess.clear();
+}
+
 void Game::LoadLevel(int level)
 {
 	// Add the systems that need to be processed in our game
 	registry->AddSystem<MovementSystem>();
-	registry->AddSystem<RenderSystem>();
 	registry->AddSystem<AnimationSystem>();
 	registry->AddSystem<CollisionSystem>();
-	registry->AddSystem<RenderColliderSystem>();
+	if (renderer)
+	{
+		registry->AddSystem<RenderSystem>();
+		registry->AddSystem<RenderColliderSystem>();
+	}
 	registry->AddSystem<DamageSystem>();
 	registry->AddSystem<KeyboardControlSystem>();
+	registry->AddSystem<TerrainResponseSystem>();
 	registry->AddSystem<CameraMovementSystem>();
 
-	// Add assets tp the asset store
-	assetStore->AddTexture(renderer, "tank-image", "./assets/images/tank-panther-right.png");
-	assetStore->AddTexture(renderer, "truck-image", "./assets/images/truck-ford-right.png");
-	assetStore->AddTexture(renderer, "chopper-image", "./assets/images/chopper-spritesheet.png");
-	assetStore->AddTexture(renderer, "radar-image", "./assets/images/radar.png");
-	assetStore->AddTexture(renderer, "tilemap-image", "./assets/tilemaps/jungle.png");
+	// The jungle colliders all have a similar size, so a grid with cells of about one tile fits best
+	registry->GetSystem<CollisionSystem>().SetBroadphase(BROADPHASE_SPATIAL_HASH);
+
+	// Projectiles never hit projectiles or the side that fired them
+	CollisionLayerMatrix& layerMatrix = registry->GetSystem<CollisionSystem>().GetLayerMatrix();
+	layerMatrix.SetCollision(COLLISION_LAYER_PLAYER_PROJECTILE, COLLISION_LAYER_PLAYER_PROJECTILE, false);
+	layerMatrix.SetCollision(COLLISION_LAYER_ENEMY_PROJECTILE, COLLISION_LAYER_ENEMY_PROJECTILE, false);
+	layerMatrix.SetCollision(COLLISION_LAYER_PLAYER_PROJECTILE, COLLISION_LAYER_ENEMY_PROJECTILE, false);
+	layerMatrix.SetCollision(COLLISION_LAYER_PLAYER_PROJECTILE, COLLISION_LAYER_PLAYER, false);
+	layerMatrix.SetCollision(COLLISION_LAYER_ENEMY_PROJECTILE, COLLISION_LAYER_ENEMY, false);
+
+	// Add assets tp the asset store, without a renderer only their handles are reserved
+	const TextureHandle tankTexture = assetStore->AddTexture(renderer, "tank-image", "./assets/images/tank-panther-right.png");
+	const TextureHandle truckTexture = assetStore->AddTexture(renderer, "truck-image", "./assets/images/truck-ford-right.png");
+	const TextureHandle chopperTexture = assetStore->AddTexture(renderer, "chopper-image", "./assets/images/chopper-spritesheet.png");
+	const TextureHandle radarTexture = assetStore->AddTexture(renderer, "radar-image", "./assets/images/radar.png");
+	const TextureHandle tilemapTexture = assetStore->AddTexture(renderer, "tilemap-image", "./assets/tilemaps/jungle.png");
+
+	// Every image of the level fits in a single atlas page
+	assetStore->BuildAtlas(renderer);
 
 	int tileSize = 32;
 	int mapNumCols = 25;
@@ -145,34 +292,36 @@ void Game::LoadLevel(int level)
 	double tileScaleX = 4.0;
 	double tileScaleY = 4.0;
 	
-	std::fstream mapFile;
-	mapFile.open("./assets/tilemaps/jungle.map");
+	Tilemap tilemap;
+	if (!tilemap.LoadFromFile("./assets/tilemaps/jungle.map", mapNumCols, mapNumRows, tileSize, glm::vec2(tileScaleX, tileScaleY)))
+	{
+		Logger::Err("Level " + std::to_string(level) + " not loaded, its tilemap is missing");
+		return;
+	}
 
-	for (int y = 0; y < mapNumRows; y++)
+	// The tiles are drawn from baked chunks instead of one sprite entity per tile
+	if (renderer)
 	{
-		for (int x = 0; x < mapNumCols; x++)
-		{
-			char ch;
-			mapFile.get(ch);
-			int srcRectY = std::atoi(&ch) * tileSize;
-			mapFile.get(ch);
-			int srcRectX = std::atoi(&ch) * tileSize;
-			mapFile.ignore();
-
-			Entity tile = registry->CreateEntity();
-			tile.AddComponent<TransformComponent>(glm::vec2(x * (tileScaleX * tileSize), y * (tileScaleY * tileSize)), glm::vec2(tileScaleX, tileScaleY), 0.0);
-			tile.AddComponent<SpriteComponent>("tilemap-image", tileSize, tileSize, 0, false, srcRectX, srcRectY);
-		}
+		tilemapRenderer = std::make_unique<TilemapRenderer>(tilemap, tilemapTexture);
 	}
-	mapFile.close();
 	mapWidth = mapNumCols * tileSize * tileScaleX;
 	mapHeight = mapNumRows * tileSize * tileScaleY;
 
-	// Create an entity
+	// jungle.solid marks the water tiles of the tileset as solid, the ones more than half covered by water
+	// The shore tiles that are mostly grass stay walkable
+	std::vector<int> solidTiles;
+	if (TilemapCollider::LoadSolidTiles("./assets/tilemaps/jungle.solid", solidTiles))
+	{
+		auto tilemapCollider = std::make_shared<TilemapCollider>();
+		tilemapCollider->Build(tilemap, solidTiles, LayerBit(COLLISION_LAYER_TERRAIN));
+		registry->GetSystem<CollisionSystem>().SetTilemapCollider(tilemapCollider);
+	}
+
+	// Create an entity, the map is an island in the sea so everything spawns on land
 	Entity chopper = registry->CreateEntity();
-	chopper.AddComponent<TransformComponent>(glm::vec2(100.0, 100.0), glm::vec2(1.0, 1.0), 0.0);
+	chopper.AddComponent<TransformComponent>(glm::vec2(1400.0, 1400.0), glm::vec2(1.0, 1.0), 0.0);
 	chopper.AddComponent<RigidBodyComponent>(glm::vec2(0.0, 0.0));
-	chopper.AddComponent<SpriteComponent>("chopper-image", 32, 32, 1);
+	chopper.AddComponent<SpriteComponent>(chopperTexture, 32, 32, 1);
 	chopper.AddComponent<AnimationComponent>(2, 5, true);
 	chopper.AddComponent<KeyboardControlledComponent>(glm::vec2(0, -180), glm::vec2(180, 0), glm::vec2(0, 180), glm::vec2(-180, 0));
 	chopper.AddComponent<CameraFollowComponent>();
@@ -180,19 +329,19 @@ void Game::LoadLevel(int level)
 	Entity radar = registry->CreateEntity();
 	radar.AddComponent<TransformComponent>(glm::vec2(windowWidth - 75, 10.0), glm::vec2(1.0, 1.0), 0.0);
 	radar.AddComponent<RigidBodyComponent>(glm::vec2(0.0, 0.0));
-	radar.AddComponent<SpriteComponent>("radar-image", 64, 64, 2, true);
+	radar.AddComponent<SpriteComponent>(radarTexture, 64, 64, 2, true);
 	radar.AddComponent<AnimationComponent>(8, 5, true);
 
 	Entity tank = registry->CreateEntity();
-	tank.AddComponent<TransformComponent>(glm::vec2(500.0, 10.0), glm::vec2(1.0, 1.0), 0.0);
+	tank.AddComponent<TransformComponent>(glm::vec2(2900.0, 1560.0), glm::vec2(1.0, 1.0), 0.0);
 	tank.AddComponent<RigidBodyComponent>(glm::vec2(-30.0, 0.0));
-	tank.AddComponent<SpriteComponent>("tank-image", 32, 32, 2);
+	tank.AddComponent<SpriteComponent>(tankTexture, 32, 32, 2);
 	tank.AddComponent<BoxColliderComponent>(32, 32);
 
 	Entity truck = registry->CreateEntity();
-	truck.AddComponent<TransformComponent>(glm::vec2(10.0, 10.0), glm::vec2(1.0, 1.0), 0.0);
+	truck.AddComponent<TransformComponent>(glm::vec2(1300.0, 1560.0), glm::vec2(1.0, 1.0), 0.0);
 	truck.AddComponent<RigidBodyComponent>(glm::vec2(20.0, 00.0));
-	truck.AddComponent<SpriteComponent>("truck-image", 32, 32, 1);
+	truck.AddComponent<SpriteComponent>(truckTexture, 32, 32, 1);
 	truck.AddComponent<BoxColliderComponent>(32, 32);
 
 }
@@ -201,23 +350,56 @@ void Game::LoadLevel(int level)
 void Game::Setup() // Equivalaent to Unity's start function
 {
 	LoadLevel(1);
+
+	// The renderer stays on this thread, the simulation only fills the snapshots the FrameRenderer draws
+	if (renderer)
+	{
+		frameRenderer = std::make_unique<FrameRenderer>(renderer, assetStore, tilemapRenderer.get());
+		performanceHud = std::make_unique<PerformanceHud>(renderer);
+	}
+
+	previousCamera = camera;
+	previousFrameCounter = SDL_GetPerformanceCounter();
 }
 
 void Game::Update()
 {
-	// If we are too fast, waste some time untill we reach the MILLISECS_PER_FRAME
-	
-	int timeToWait = MILLISECS_PER_FRAME - (SDL_GetTicks() - millisecsPreviousFrame);
-	if (timeToWait > 0 && timeToWait <= MILLISECS_PER_FRAME)
+	PROFILE_SCOPE("Game::Update");
+	// If we are too fast, wait for the deadline of the frame
+	// Headless and server runs always run a single tick per frame, so every run simulates exactly the same ticks
+	if (config.IsPaced())
 	{
-		SDL_Delay(timeToWait);
+		framePacer->WaitForNextFrame();
 	}
-	
-	// The difference in ticks sincce the last frame, converted in seconds
-	double deltaTime = (SDL_GetTicks() - millisecsPreviousFrame) / 1000.0;
 
-	// Store the current frame time
-	millisecsPreviousFrame = SDL_GetTicks();
+	const double tickTime = 1.0 / config.tickRate;
+
+	// The time since the last frame at the resolution of the performance counter
+	const Uint64 frameCounter = SDL_GetPerformanceCounter();
+	const double frameTime = static_cast<double>(frameCounter - previousFrameCounter) / SDL_GetPerformanceFrequency();
+	previousFrameCounter = frameCounter;
+	accumulator += config.HasVirtualClock() ? tickTime : frameTime;
+
+	int numTicks = 0;
+	while (accumulator >= tickTime && numTicks < MAX_TICKS_PER_FRAME)
+	{
+		Tick(tickTime);
+		accumulator -= tickTime;
+		numTicks++;
+	}
+
+	// Too far behind, drop the time that can't be simulated so the next frames do not have even more ticks to run
+	if (accumulator >= tickTime)
+	{
+		accumulator = 0.0;
+	}
+	interpolationAlpha = static_cast<float>(accumulator / tickTime);
+}
+
+void Game::Tick(double deltaTime)
+{
+	PROFILE_SCOPE("Game::Tick");
+	previousCamera = camera;
 
 	// Reset all event handlers for the current frame
 	eventBus->Reset();
@@ -225,51 +407,169 @@ void Game::Update()
 	// Perform the subscription of the events for all systems
 	registry->GetSystem<DamageSystem>().SubscribeToEvents(eventBus);
 	registry->GetSystem<KeyboardControlSystem>().SubscribeToEvents(eventBus);
+	registry->GetSystem<TerrainResponseSystem>().SubscribeToEvents(eventBus);
 
 	// Update the registry to process the entities that are waiting to be created/deleted
 	registry->Update();
 
 	// Invoke all the systems to needs to update
 	registry->GetSystem<MovementSystem>().Update(deltaTime);
-	registry->GetSystem<AnimationSystem>().Update();
-	registry->GetSystem<CollisionSystem>().Update(eventBus);
+	registry->GetSystem<AnimationSystem>().Update(tickCount * 1000 / config.tickRate);
+	registry->GetSystem<CollisionSystem>().Update(eventBus, deltaTime, threadPool);
 	registry->GetSystem<CameraMovementSystem>().Update(camera);
+
+	tickCount++;
 }
 
 void Game::Render()
 {
-	SDL_SetRenderDrawColor(renderer, 21, 21, 21, 255);
-	SDL_RenderClear(renderer);
+	PROFILE_SCOPE("Game::Render");
+	if (!frameRenderer)
+	{
+		return;
+	}
+
+	// Hand the frame over to the FrameRenderer, in windowed mode the simulation goes on with the next frame while it is drawn
+	RenderSnapshot& snapshot = frameRenderer->BeginSnapshot();
+	snapshot.frame = frameCount;
+
+	// Draw between the last two ticks, the camera moves at the tick rate too
+	snapshot.camera = {
+		static_cast<int>(std::lround(previousCamera.x + (camera.x - previousCamera.x) * interpolationAlpha)),
+		static_cast<int>(std::lround(previousCamera.y + (camera.y - previousCamera.y) * interpolationAlpha)),
+		camera.w,
+		camera.h
+	};
 
 	// Invoke all the systems that needs to render
-	registry->GetSystem<RenderSystem>().Update(renderer, assetStore, camera);
+	registry->GetSystem<RenderSystem>().Update(snapshot, assetStore, snapshot.camera, interpolationAlpha);
 
 	if (isDebug)
 	{
-		registry->GetSystem<RenderColliderSystem>().Update(renderer, camera);
+		registry->GetSystem<RenderColliderSystem>().Update(snapshot, snapshot.camera);
+		performanceHud->Update(snapshot, registry, eventBus, *framePacer, frameRenderer->GetStats());
+	}
+
+	frameRenderer->PublishSnapshot();
+}
 
+// One frame of the simulation: the queued keys, the ticks and the snapshot to draw
+void Game::RunFrame()
+{
+	PROFILE_FRAME();
+	PROFILE_SCOPE("Game::Frame");
+#if EVENTBUS_STATS
+	// The event statistics cover a single frame
+	eventBus->ResetStats();
+#endif
+	ProcessKeys();
+	Update();
+	Render();
+
+#if EVENTBUS_STATS
+	// Written once every handler of the frame ran, the counters are reset at the start of the next one
+	if (isEventStatsRequested || (config.eventStatsFrame > 0 && frameCount + 1 == config.eventStatsFrame))
+	{
+		std::ofstream stream("event_stats.csv");
+		eventBus->ExportStats(stream);
+		Logger::Log("Event statistics of frame " + std::to_string(frameCount + 1) + " written to event_stats.csv");
+		isEventStatsRequested = false;
 	}
+#endif
 
-	SDL_RenderPresent(renderer);
+	frameCount++;
+	if (config.maxFrames > 0 && frameCount >= config.maxFrames)
+	{
+		isRunning = false;
+	}
+}
+
+void Game::SimulationLoop()
+{
+	PROFILE_THREAD("Simulation");
+	while (isRunning)
+	{
+		RunFrame();
+	}
 }
 
 void Game::Run()
 {
 	Setup();
-	while (isRunning)
+	PROFILE_THREAD("Main");
+	// The capture follows the frames of whichever thread runs the simulation
+#if PROFILER_ENABLED
+	if (config.profileFrames > 0)
+	{
+		Profiler::CaptureFrames(config.profileFrames, "profile.json");
+	}
+#endif
+#if !EVENTBUS_STATS
+	if (config.eventStatsFrame > 0)
+	{
+		Logger::Err("--event-stats needs a build with EVENTBUS_STATS");
+	}
+#endif
+	const Uint64 startCounter = SDL_GetPerformanceCounter();
+
+	if (config.isHeadless || !frameRenderer)
+	{
+		// Headless and server runs simulate and draw every frame in lockstep on this thread, so every frame is drawn and timed
+		while (isRunning)
+		{
+			ProcessInput();
+			RunFrame();
+			if (frameRenderer)
+			{
+				frameRenderer->DrawNextSnapshot(std::chrono::milliseconds(0));
+			}
+		}
+	}
+	else
 	{
-		ProcessInput();
-		Update();
-		Render();
-		//Destroy();
+		// The window is only drawn and pumped from this thread, the simulation runs on its own
+		simulationThread = std::thread(&Game::SimulationLoop, this);
+		while (isRunning)
+		{
+			ProcessInput();
+			// The wait is short so the events keep being pumped when the simulation stalls
+			frameRenderer->DrawNextSnapshot(std::chrono::milliseconds(SNAPSHOT_WAIT_MILLISECONDS));
+		}
+		simulationThread.join();
+	}
 
+	const double seconds = static_cast<double>(SDL_GetPerformanceCounter() - startCounter) / SDL_GetPerformanceFrequency();
+	if (frameCount > 0)
+	{
+		Logger::Log("Ran " + std::to_string(frameCount) + " frames in " + std::to_string(seconds) + " s, " + std::to_string(seconds * 1000.0 / frameCount) + " ms per frame");
+	}
+	if (config.IsPaced())
+	{
+		const FrameTimeStats frameStats = framePacer->GetStats();
+		Logger::Log("Frame time over the last " + std::to_string(frameStats.numFrames) + " frames: p50 " + std::to_string(frameStats.p50) +
+			" ms, p95 " + std::to_string(frameStats.p95) + " ms, p99 " + std::to_string(frameStats.p99) + " ms, max " + std::to_string(frameStats.max) +
+			" ms, " + std::to_string(frameStats.droppedFrames) + " dropped frames");
 	}
 }
 
 void Game::Destroy()
 {
-	SDL_DestroyRenderer(renderer);
-	SDL_DestroyWindow(window);
+	// The chunk and font textures belong to the renderer
+	frameRenderer.reset();
+	performanceHud.reset();
+	tilemapRenderer.reset();
+	if (renderer)
+	{
+		SDL_DestroyRenderer(renderer);
+	}
+	if (window)
+	{
+		SDL_DestroyWindow(window);
+	}
+	if (offscreenSurface)
+	{
+		SDL_FreeSurface(offscreenSurface);
+	}
 	SDL_Quit();
 }
 
@@ -1,40 +1,91 @@
 #pragma once
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "../AssetStore/AssetStore.h"
 #include "../EventBus/EventBus.h"
+#include "../ThreadPool/ThreadPool.h"
+#include "../FramePacer/FramePacer.h"
+#include "GameConfig.h"
 
 
+// Frame rate when neither --fps nor the display gives one
 const int FPS = 60;
-const int MILLISECS_PER_FRAME = 1000 / FPS;
+
+// Simulation ticks run in a single frame at most, a slower machine drops the time it can't catch up instead of falling further behind
+const int MAX_TICKS_PER_FRAME = 5;
+
+// Longest the main thread waits for a new snapshot before pumping the events again
+const int SNAPSHOT_WAIT_MILLISECONDS = 5;
+
+// Frames captured by the profiler when F2 is pressed, two seconds at 60 Hz
+const int PROFILE_CAPTURE_FRAMES = 120;
 
 class SDL_Window;
 class SDL_Renderer;
+struct SDL_Surface;
 class Registry;
 class AssetStore;
+class TilemapRenderer;
+class FrameRenderer;
+class PerformanceHud;
 
 class Game
 {
 private:
-	bool isRunning;
+	// Cleared by either thread, the main thread pumping the events or the simulation thread reaching the last frame
+	std::atomic<bool> isRunning;
 	bool isDebug;
-	int millisecsPreviousFrame = 0;
+	// Fixed timestep, the frame time is accumulated and consumed in ticks of 1 / config.tickRate seconds
+	Uint64 previousFrameCounter = 0;
+	double accumulator = 0.0;
+	// Fraction of a tick left in the accumulator, rendering interpolates the transforms and the camera by it
+	float interpolationAlpha = 0.0f;
+	// Virtual clock of the simulation, the game time is tickCount / config.tickRate
+	Uint64 tickCount = 0;
+	SDL_Rect previousCamera;
 	SDL_Window* window;
 	SDL_Renderer* renderer;
 	SDL_Rect camera;
 
+	GameConfig config;
+	// Target of the software renderer in headless mode
+	SDL_Surface* offscreenSurface = nullptr;
+	int frameCount = 0;
+	// F3 writes the event counters of the current frame once it ends
+	bool isEventStatsRequested = false;
+
 	std::unique_ptr<Registry> registry;
 	std::unique_ptr<AssetStore> assetStore;
 	std::unique_ptr<EventBus> eventBus;
+	std::unique_ptr<ThreadPool> threadPool;
+	std::unique_ptr<FramePacer> framePacer;
+	std::unique_ptr<TilemapRenderer> tilemapRenderer;
+	std::unique_ptr<FrameRenderer> frameRenderer;
+
+	// Windowed runs simulate on this thread while the main thread pumps the events and draws
+	std::thread simulationThread;
+	// Keys pressed since the last simulation frame, handed from the main thread to the simulation
+	std::mutex inputMutex;
+	std::vector<SDL_Keycode> pendingKeys;
+	std::vector<SDL_Keycode> keysToProcess;
+	std::unique_ptr<PerformanceHud> performanceHud;
 
 public:
-	Game();
+	Game(const GameConfig& config = GameConfig());
 	~Game();
 	void Initialize();
 	void Run();
 	void Setup(); // Equivalaent to Unity's start function
 	void LoadLevel(int level);
 	void ProcessInput();
+	void ProcessKeys();
+	void RunFrame();
+	void SimulationLoop();
 	void Update();
+	void Tick(double deltaTime);
 	void Render();
 	void Destroy();
 
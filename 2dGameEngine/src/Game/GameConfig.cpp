@@ -0,0 +1,88 @@
+#include "GameConfig.h"
+#include "../Logger/Logger.h"
+#include <cstdlib>
+#include <string>
+
+GameConfig GameConfig::FromCommandLine(int argc, char* argv[])
+{
+	GameConfig config;
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (arg == "--headless")
+		{
+			config.isHeadless = true;
+		}
+		else if (arg == "--server")
+		{
+			config.isServer = true;
+		}
+		else if (arg == "--fast")
+		{
+			config.isFast = true;
+		}
+		else if (arg == "--no-vsync")
+		{
+			config.isVsync = false;
+		}
+		else if (arg == "--width" && hasValue)
+		{
+			config.windowWidth = std::atoi(argv[++i]);
+		}
+		else if (arg == "--height" && hasValue)
+		{
+			config.windowHeight = std::atoi(argv[++i]);
+		}
+		else if (arg == "--frames" && hasValue)
+		{
+			config.maxFrames = std::atoi(argv[++i]);
+		}
+		else if (arg == "--fps" && hasValue)
+		{
+			config.frameRate = std::atoi(argv[++i]);
+		}
+		else if (arg == "--tick-rate" && hasValue)
+		{
+			config.tickRate = std::atoi(argv[++i]);
+		}
+		else if (arg == "--profile" && hasValue)
+		{
+			config.profileFrames = std::atoi(argv[++i]);
+		}
+		else if (arg == "--event-stats" && hasValue)
+		{
+			config.eventStatsFrame = std::atoi(argv[++i]);
+		}
+		else
+		{
+			Logger::Err("Unknown command line argument " + arg);
+		}
+	}
+
+	if (config.tickRate <= 0)
+	{
+		Logger::Err("The tick rate must be positive, using 60");
+		config.tickRate = 60;
+	}
+
+	if (config.frameRate < 0)
+	{
+		Logger::Err("The frame rate must be positive, following the display");
+		config.frameRate = 0;
+	}
+
+	if (config.isServer && config.isHeadless)
+	{
+		Logger::Err("--server already runs without rendering, ignoring --headless");
+		config.isHeadless = false;
+	}
+
+	// Headless runs are benchmarks, the software renderer has no display to sync with
+	if (config.isHeadless)
+	{
+		config.isVsync = false;
+	}
+	return config;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+/*
+* Startup options of the game, read from the command line
+* --headless        Render with the software renderer into an offscreen surface, no window and no display needed
+* --width <pixels>  Resolution, the display resolution in fullscreen when not given
+* --height <pixels>
+* --frames <count>  Quit after this many frames, 0 runs until the game is closed
+* --no-vsync        Do not wait for the vertical blank when presenting
+* --fps <hz>        Frames per second in a window, the refresh rate of the display when not given
+* --tick-rate <hz>  Simulation ticks per second, independent of the frame rate
+* --server          Simulation only for dedicated servers, no video, no renderer and no textures, one tick per frame at the tick rate
+* --fast            With --server, run the ticks as fast as possible instead of at the tick rate
+* --profile <count> Capture the first frames into profile.json, needs a build with PROFILER_ENABLED
+* --event-stats <frame> Write the event counters of that frame into event_stats.csv, needs a build with EVENTBUS_STATS
+*/
+struct GameConfig
+{
+	bool isHeadless = false;
+	bool isServer = false;
+	bool isFast = false;
+	int windowWidth = 0;
+	int windowHeight = 0;
+	int maxFrames = 0;
+	bool isVsync = true;
+	// 0 follows the refresh rate of the display
+	int frameRate = 0;
+	int tickRate = 60;
+	int profileFrames = 0;
+	int eventStatsFrame = 0;
+
+	static GameConfig FromCommandLine(int argc, char* argv[]);
+
+	// Game time only advances by whole ticks, one per frame, instead of following the wall clock
+	bool HasVirtualClock() const
+	{
+		return isHeadless || isServer;
+	}
+
+	// Frames wait for their deadline, at the frame rate or at the tick rate of a server
+	bool IsPaced() const
+	{
+		return !isHeadless && !(isServer && isFast);
+	}
+};
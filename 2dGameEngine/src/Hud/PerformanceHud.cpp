@@ -0,0 +1,166 @@
+#include "PerformanceHud.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <imgui/imgui.h>
+#include <chrono>
+
+// Frame time graph range, twice the budget of a 60 Hz frame
+static const float FRAME_TIME_GRAPH_MAX = 33.3f;
+// The HUD turns its own cost red above this
+static const double HUD_BUDGET_MILLISECONDS = 0.2;
+
+PerformanceHud::PerformanceHud(SDL_Renderer* renderer)
+{
+	context = ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+
+	int width = 0;
+	int height = 0;
+	SDL_GetRendererOutputSize(renderer, &width, &height);
+	io.DisplaySize = ImVec2(static_cast<float>(width), static_cast<float>(height));
+
+	unsigned char* pixels = nullptr;
+	int fontWidth = 0;
+	int fontHeight = 0;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &fontWidth, &fontHeight);
+	fontTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, fontWidth, fontHeight);
+	if (!fontTexture)
+	{
+		Logger::Err("Error creating the HUD font texture");
+	}
+	else
+	{
+		SDL_UpdateTexture(fontTexture, nullptr, pixels, fontWidth * 4);
+		SDL_SetTextureBlendMode(fontTexture, SDL_BLENDMODE_BLEND);
+	}
+	io.Fonts->TexID = fontTexture;
+}
+
+PerformanceHud::~PerformanceHud()
+{
+	ImGui::DestroyContext(context);
+	if (fontTexture)
+	{
+		SDL_DestroyTexture(fontTexture);
+	}
+}
+
+void PerformanceHud::AddDrawData(RenderSnapshot& snapshot) const
+{
+	const ImDrawData* drawData = ImGui::GetDrawData();
+	for (int list = 0; list < drawData->CmdListsCount; list++)
+	{
+		const ImDrawList* drawList = drawData->CmdLists[list];
+		const int firstVertex = static_cast<int>(snapshot.overlayVertices.size());
+
+		for (const ImDrawVert& vertex : drawList->VtxBuffer)
+		{
+			// ImGui packs the colors as ABGR, which is RGBA in memory
+			const SDL_Color color = {
+				static_cast<Uint8>(vertex.col & 0xFF),
+				static_cast<Uint8>((vertex.col >> 8) & 0xFF),
+				static_cast<Uint8>((vertex.col >> 16) & 0xFF),
+				static_cast<Uint8>((vertex.col >> 24) & 0xFF)
+			};
+			snapshot.overlayVertices.push_back({ { vertex.pos.x, vertex.pos.y }, color, { vertex.uv.x, vertex.uv.y } });
+		}
+
+		for (const ImDrawCmd& command : drawList->CmdBuffer)
+		{
+			if (command.UserCallback || command.ElemCount == 0)
+			{
+				continue;
+			}
+
+			const SDL_Rect clipRect = {
+				static_cast<int>(command.ClipRect.x),
+				static_cast<int>(command.ClipRect.y),
+				static_cast<int>(command.ClipRect.z - command.ClipRect.x),
+				static_cast<int>(command.ClipRect.w - command.ClipRect.y)
+			};
+			const int firstIndex = static_cast<int>(snapshot.overlayIndices.size());
+			for (unsigned int i = 0; i < command.ElemCount; i++)
+			{
+				snapshot.overlayIndices.push_back(firstVertex + static_cast<int>(command.VtxOffset + drawList->IdxBuffer[command.IdxOffset + i]));
+			}
+			snapshot.overlayDraws.push_back({ static_cast<SDL_Texture*>(command.TextureId), clipRect, firstIndex, static_cast<int>(command.ElemCount) });
+		}
+	}
+}
+
+void PerformanceHud::Update(RenderSnapshot& snapshot, std::unique_ptr<Registry>& registry, std::unique_ptr<EventBus>& eventBus, const FramePacer& framePacer,
+	const RenderStats& renderStats)
+{
+	PROFILE_SCOPE("PerformanceHud::Update");
+	const auto start = std::chrono::steady_clock::now();
+
+	ImGuiIO& io = ImGui::GetIO();
+	// Nothing in the HUD animates or takes input, the delta time only has to be positive
+	io.DeltaTime = 1.0f / 60.0f;
+	ImGui::NewFrame();
+
+	ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f));
+	ImGui::SetNextWindowBgAlpha(0.7f);
+	ImGui::Begin("Performance", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings |
+		ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoInputs);
+
+	// Frame times
+	const FrameTimeStats frameStats = framePacer.GetStats();
+	ImGui::Text("Frame  avg %.2f  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", frameStats.average, frameStats.p50, frameStats.p95, frameStats.p99, frameStats.max);
+	ImGui::Text("Dropped frames %d", frameStats.droppedFrames);
+	auto getFrameTime = [](void* data, int index)
+	{
+		return static_cast<float>(static_cast<const FramePacer*>(data)->GetFrameTime(index));
+	};
+	ImGui::PlotLines("##FrameTimes", getFrameTime, const_cast<FramePacer*>(&framePacer), framePacer.GetNumFrameTimes(), 0, nullptr, 0.0f,
+		FRAME_TIME_GRAPH_MAX, ImVec2(320.0f, 60.0f));
+
+	// Time per scope of the last frame, nested scopes are indented under their parent
+	ImGui::Separator();
+#if PROFILER_ENABLED
+	for (const ProfileTiming& timing : Profiler::GetFrameTimings())
+	{
+		ImGui::Text("%*s%-32s %7.3f ms  x%d", timing.depth * 2, "", timing.name, timing.nanoseconds / 1000000.0, timing.calls);
+	}
+#else
+	ImGui::TextUnformatted("System timings need a build with PROFILER_ENABLED");
+#endif
+
+	// Entities and component pools
+	ImGui::Separator();
+	ImGui::Text("Entities %d", registry->GetNumEntities());
+	registry->GetPoolStats(poolStats);
+	size_t totalMemory = 0;
+	for (const ComponentPoolStats& pool : poolStats)
+	{
+		ImGui::Text("  %-40s %5d / %5d  %8.1f KB", pool.componentName, pool.numComponents, pool.size, pool.memorySize / 1024.0);
+		totalMemory += pool.memorySize;
+	}
+	ImGui::Text("Component pools %.1f KB", totalMemory / 1024.0);
+
+	// Events emitted during this frame
+#if EVENTBUS_STATS
+	ImGui::Separator();
+	for (const auto& typeStats : eventBus->GetStats())
+	{
+		ImGui::Text("  %-40s %5u emitted  %5u handled", typeStats.second.eventName, typeStats.second.emitCount, typeStats.second.handlerInvocations);
+	}
+#endif
+
+	// Rendering, as of the last frame drawn
+	ImGui::Separator();
+	ImGui::Text("Sprites %d drawn  %d culled", renderStats.submitted, renderStats.culled);
+	ImGui::Text("Draw calls %d  texture switches %d (%d unsorted)", renderStats.drawCalls, renderStats.stateChangesAfterSort, renderStats.stateChangesBeforeSort);
+	ImGui::Text("Drawing %.3f ms", renderStats.drawMilliseconds);
+
+	const double hudMilliseconds = buildMilliseconds + renderStats.overlayMilliseconds;
+	const ImVec4 hudColor = hudMilliseconds > HUD_BUDGET_MILLISECONDS ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(0.6f, 1.0f, 0.6f, 1.0f);
+	ImGui::TextColored(hudColor, "HUD %.3f ms (build %.3f, draw %.3f)", hudMilliseconds, buildMilliseconds, renderStats.overlayMilliseconds);
+
+	ImGui::End();
+	ImGui::Render();
+	AddDrawData(snapshot);
+
+	buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
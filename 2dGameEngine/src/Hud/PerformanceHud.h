@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../EventBus/EventBus.h"
+#include "../FramePacer/FramePacer.h"
+#include "../Renderer/RenderSnapshot.h"
+#include <SDL.h>
+#include <memory>
+#include <vector>
+
+struct ImGuiContext;
+
+/*
+* Debug overlay with the frame times, the time spent per system, the entity, pool and event counts and the render stats
+* The ImGui frame is built on the simulation thread and its triangles are copied into the RenderSnapshot, the FrameRenderer
+* draws them with SDL_RenderGeometry like the sprite batches, so ImGui itself is never touched by two threads.
+* The window takes no input, it stays out of the way of the game and keeps building it cheap.
+*/
+class PerformanceHud
+{
+private:
+	ImGuiContext* context = nullptr;
+	SDL_Texture* fontTexture = nullptr;
+
+	// Time the previous Update() took, shown on the next frame
+	double buildMilliseconds = 0.0;
+
+	// Scratch of the pool list, kept to avoid allocating every frame
+	std::vector<ComponentPoolStats> poolStats;
+
+	void AddDrawData(RenderSnapshot& snapshot) const;
+
+public:
+	// Uploads the font texture, the renderer must not be used by another thread yet
+	PerformanceHud(SDL_Renderer* renderer);
+	// The FrameRenderer must be done with the font texture
+	~PerformanceHud();
+
+	// Build the HUD and add it to the snapshot
+	void Update(RenderSnapshot& snapshot, std::unique_ptr<Registry>& registry, std::unique_ptr<EventBus>& eventBus, const FramePacer& framePacer,
+		const RenderStats& renderStats);
+};
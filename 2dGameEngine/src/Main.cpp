@@ -2,7 +2,7 @@
 
 int main(int argc, char* argv[]) {
    
-    Game game;
+    Game game(GameConfig::FromCommandLine(argc, argv));
 
     game.Initialize();
     game.Run();
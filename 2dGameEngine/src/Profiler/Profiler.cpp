@@ -0,0 +1,214 @@
+#include "Profiler.h"
+
+#if PROFILER_ENABLED
+#include "../Logger/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+std::mutex Profiler::buffersMutex;
+std::vector<std::unique_ptr<ProfilerThreadBuffer>> Profiler::buffers;
+int Profiler::framesToCapture = 0;
+int Profiler::capturedFrames = -1;
+int64_t Profiler::captureStart = 0;
+std::string Profiler::capturePath;
+uint64_t Profiler::frameFirstEvent = 0;
+std::vector<ProfileTiming> Profiler::frameTimings;
+
+// Buffer of the calling thread, it stays registered until the program exits so a capture can still read it after the thread ended
+static thread_local ProfilerThreadBuffer* threadBuffer = nullptr;
+
+int64_t Profiler::Now()
+{
+	static const auto epoch = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+ProfilerThreadBuffer& Profiler::GetThreadBuffer()
+{
+	if (!threadBuffer)
+	{
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		auto buffer = std::make_unique<ProfilerThreadBuffer>();
+		buffer->threadId = static_cast<int>(buffers.size()) + 1;
+		buffer->threadName = "Thread " + std::to_string(buffer->threadId);
+		threadBuffer = buffer.get();
+		buffers.push_back(std::move(buffer));
+	}
+	return *threadBuffer;
+}
+
+int64_t Profiler::BeginScope()
+{
+	GetThreadBuffer().depth++;
+	return Now();
+}
+
+void Profiler::EndScope(const char* name, int64_t start)
+{
+	const int64_t end = Now();
+	ProfilerThreadBuffer& buffer = GetThreadBuffer();
+	buffer.depth--;
+
+	const uint64_t index = buffer.writeIndex.load(std::memory_order_relaxed);
+	buffer.events[index % ProfilerThreadBuffer::CAPACITY] = { name, start, end, buffer.depth };
+	buffer.writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	ProfilerThreadBuffer& buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	buffer.threadName = name;
+}
+
+void Profiler::MarkFrame()
+{
+	GatherFrameTimings();
+
+	if (framesToCapture > 0 && capturedFrames < 0)
+	{
+		captureStart = Now();
+		capturedFrames = 0;
+		return;
+	}
+
+	if (capturedFrames >= 0 && ++capturedFrames == framesToCapture)
+	{
+		WriteCapture(Now());
+		framesToCapture = 0;
+		capturedFrames = -1;
+	}
+}
+
+void Profiler::GatherFrameTimings()
+{
+	// The calling thread owns the buffer, so none of these slots can change under us
+	const ProfilerThreadBuffer& buffer = GetThreadBuffer();
+	const uint64_t writeIndex = buffer.writeIndex.load(std::memory_order_relaxed);
+	const uint64_t first = std::max(frameFirstEvent, writeIndex > ProfilerThreadBuffer::CAPACITY ? writeIndex - ProfilerThreadBuffer::CAPACITY : 0);
+	frameFirstEvent = writeIndex;
+
+	// A frame only has a few dozen distinct scopes, a linear search beats hashing
+	frameTimings.clear();
+	for (uint64_t i = first; i < writeIndex; i++)
+	{
+		const ProfileEvent& event = buffer.events[i % ProfilerThreadBuffer::CAPACITY];
+		auto timing = std::find_if(frameTimings.begin(), frameTimings.end(), [&event](const ProfileTiming& timing)
+			{
+				return timing.name == event.name && timing.depth == event.depth;
+			});
+		if (timing == frameTimings.end())
+		{
+			frameTimings.push_back({ event.name, event.depth, 1, event.end - event.start, event.start });
+			continue;
+		}
+		timing->calls++;
+		timing->nanoseconds += event.end - event.start;
+		timing->firstStart = std::min(timing->firstStart, event.start);
+	}
+
+	std::sort(frameTimings.begin(), frameTimings.end(), [](const ProfileTiming& a, const ProfileTiming& b)
+		{
+			return a.firstStart != b.firstStart ? a.firstStart < b.firstStart : a.depth < b.depth;
+		});
+}
+
+const std::vector<ProfileTiming>& Profiler::GetFrameTimings()
+{
+	return frameTimings;
+}
+
+void Profiler::CaptureFrames(int numFrames, const std::string& path)
+{
+	if (IsCapturing() || numFrames <= 0)
+	{
+		return;
+	}
+	framesToCapture = numFrames;
+	capturePath = path;
+	Logger::Log("Profiler capturing the next " + std::to_string(numFrames) + " frames");
+}
+
+bool Profiler::IsCapturing()
+{
+	return framesToCapture > 0;
+}
+
+// Names are escaped in case a scope is named after something that is not a plain identifier
+static void WriteJsonString(std::ofstream& stream, const std::string& text)
+{
+	stream << '"';
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+		{
+			stream << '\\';
+		}
+		stream << (static_cast<unsigned char>(c) < 0x20 ? ' ' : c);
+	}
+	stream << '"';
+}
+
+void Profiler::WriteCapture(int64_t captureEnd)
+{
+	std::ofstream stream(capturePath);
+	if (!stream)
+	{
+		Logger::Err("Profiler could not write the capture to " + capturePath);
+		return;
+	}
+	// Timestamps are in microseconds, keep the nanoseconds
+	stream << std::fixed << std::setprecision(3);
+
+	std::vector<ProfileEvent> events;
+	size_t numEvents = 0;
+	std::lock_guard<std::mutex> lock(buffersMutex);
+
+	stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"2dGameEngine\"}}";
+
+	for (const auto& buffer : buffers)
+	{
+		stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":";
+		WriteJsonString(stream, buffer->threadName);
+		stream << "}}";
+
+		// Copy what the ring holds, then drop the slots the owning thread overwrote during the copy
+		const uint64_t firstWrite = buffer->writeIndex.load(std::memory_order_acquire);
+		const uint64_t first = firstWrite > ProfilerThreadBuffer::CAPACITY ? firstWrite - ProfilerThreadBuffer::CAPACITY : 0;
+		events.clear();
+		for (uint64_t i = first; i < firstWrite; i++)
+		{
+			events.push_back(buffer->events[i % ProfilerThreadBuffer::CAPACITY]);
+		}
+		// The owning thread may already be filling slot lastWrite, which is the same slot as lastWrite - CAPACITY
+		const uint64_t lastWrite = buffer->writeIndex.load(std::memory_order_acquire);
+		const uint64_t overwritten = lastWrite + 1 > ProfilerThreadBuffer::CAPACITY ? lastWrite + 1 - ProfilerThreadBuffer::CAPACITY : 0;
+		const size_t skipped = static_cast<size_t>(std::min<uint64_t>(std::max(first, overwritten) - first, events.size()));
+
+		if (first > 0 && (skipped == events.size() || events[skipped].start > captureStart))
+		{
+			Logger::Err("Profiler ring buffer of " + buffer->threadName + " wrapped, its trace starts late");
+		}
+
+		for (size_t i = skipped; i < events.size(); i++)
+		{
+			const ProfileEvent& event = events[i];
+			if (event.end < captureStart || event.start > captureEnd)
+			{
+				continue;
+			}
+			stream << ",\n{\"name\":";
+			WriteJsonString(stream, event.name);
+			stream << ",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+				<< ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+			numEvents++;
+		}
+	}
+	stream << "\n]}\n";
+
+	Logger::Log("Profiler wrote " + std::to_string(numEvents) + " scopes of " + std::to_string(framesToCapture) + " frames to " + capturePath);
+}
+#endif
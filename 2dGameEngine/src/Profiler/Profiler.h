@@ -0,0 +1,134 @@
+#pragma once
+
+#include <string>
+
+// Set PROFILER_ENABLED to 0 to compile the scopes out completely, release builds leave it off unless it is defined
+#ifndef PROFILER_ENABLED
+#ifdef NDEBUG
+#define PROFILER_ENABLED 0
+#else
+#define PROFILER_ENABLED 1
+#endif
+#endif
+
+#if PROFILER_ENABLED
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// One closed scope, the timestamps are nanoseconds of the steady clock since the profiler started
+struct ProfileEvent
+{
+	const char* name;
+	int64_t start;
+	int64_t end;
+	int depth;
+};
+
+// Time spent in the scopes of one name and depth during the last frame of the main loop
+struct ProfileTiming
+{
+	const char* name;
+	int depth;
+	int calls;
+	int64_t nanoseconds;
+	// Start of the first call, the timings are sorted by it so every scope comes right before the scopes it contains
+	int64_t firstStart;
+};
+
+/*
+* Ring buffer of the scopes closed by one thread
+* Only the owning thread writes, it fills a slot and then publishes it by bumping writeIndex, so recording never takes a lock.
+* A reader copies the slots it wants and checks writeIndex again afterwards, the slots overwritten meanwhile are thrown away.
+*/
+struct ProfilerThreadBuffer
+{
+	static const int CAPACITY = 1 << 15;
+
+	std::vector<ProfileEvent> events = std::vector<ProfileEvent>(CAPACITY);
+	std::atomic<uint64_t> writeIndex = 0;
+	int depth = 0;
+	int threadId = 0;
+	std::string threadName;
+};
+
+/*
+* Hierarchical CPU profiler, code is instrumented with PROFILE_SCOPE("name")
+* Every thread records into its own ProfilerThreadBuffer, the buffers are only locked when a thread records its first scope and when a capture is written.
+* A capture covers a range of frames and is written as a chrome://tracing / Perfetto JSON trace once the last frame ends.
+*/
+class Profiler
+{
+private:
+	static std::mutex buffersMutex;
+	static std::vector<std::unique_ptr<ProfilerThreadBuffer>> buffers;
+
+	// Capture state, only touched by the thread calling MarkFrame()
+	static int framesToCapture;
+	static int capturedFrames;
+	static int64_t captureStart;
+	static std::string capturePath;
+
+	// Write index of the frame thread buffer at the previous MarkFrame()
+	static uint64_t frameFirstEvent;
+	static std::vector<ProfileTiming> frameTimings;
+
+	static ProfilerThreadBuffer& GetThreadBuffer();
+	static void WriteCapture(int64_t captureEnd);
+	static void GatherFrameTimings();
+
+public:
+	// Nanoseconds since the profiler started
+	static int64_t Now();
+
+	static int64_t BeginScope();
+	static void EndScope(const char* name, int64_t start);
+
+	// Name of the calling thread in the trace
+	static void SetThreadName(const std::string& name);
+
+	// Frame boundary of the main loop, captures start and stop on it
+	static void MarkFrame();
+
+	// Scopes closed by the thread calling MarkFrame() during the last frame
+	static const std::vector<ProfileTiming>& GetFrameTimings();
+
+	// Capture the next numFrames frames into a trace file, ignored while a capture is running
+	static void CaptureFrames(int numFrames, const std::string& path);
+	static bool IsCapturing();
+};
+
+class ProfileScope
+{
+private:
+	const char* name;
+	int64_t start;
+
+public:
+	ProfileScope(const char* name) : name(name), start(Profiler::BeginScope())
+	{
+	}
+
+	~ProfileScope()
+	{
+		Profiler::EndScope(name, start);
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// The name must be a string literal or outlive the profiler, only the pointer is recorded
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::SetThreadName(name)
+#define PROFILE_FRAME() Profiler::MarkFrame()
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_THREAD(name)
+#define PROFILE_FRAME()
+#endif
@@ -0,0 +1,131 @@
+#include "FrameRenderer.h"
+#include "../Tilemap/TilemapRenderer.h"
+#include "../Profiler/Profiler.h"
+
+FrameRenderer::FrameRenderer(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, TilemapRenderer* tilemapRenderer) :
+	renderer(renderer),
+	assetStore(assetStore),
+	tilemapRenderer(tilemapRenderer)
+{
+}
+
+RenderSnapshot& FrameRenderer::BeginSnapshot()
+{
+	RenderSnapshot& snapshot = snapshots[writeIndex];
+	snapshot.Clear();
+	return snapshot;
+}
+
+void FrameRenderer::PublishSnapshot()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		// An unread snapshot is replaced by the newer one
+		std::swap(writeIndex, readyIndex);
+		hasNewSnapshot = true;
+	}
+	snapshotReady.notify_one();
+}
+
+void FrameRenderer::InvalidateTargets()
+{
+	areTargetsLost = true;
+}
+
+void FrameRenderer::InvalidateDevice()
+{
+	isDeviceLost = true;
+}
+
+RenderStats FrameRenderer::GetStats()
+{
+	std::lock_guard<std::mutex> lock(statsMutex);
+	return stats;
+}
+
+bool FrameRenderer::DrawNextSnapshot(std::chrono::milliseconds timeout)
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (!snapshotReady.wait_for(lock, timeout, [this]() { return hasNewSnapshot; }))
+		{
+			return false;
+		}
+		std::swap(readIndex, readyIndex);
+		hasNewSnapshot = false;
+	}
+
+	if (isDeviceLost)
+	{
+		assetStore->RestoreTextures(renderer);
+		if (tilemapRenderer)
+		{
+			tilemapRenderer->ReleaseTextures();
+		}
+	}
+	else if (areTargetsLost && tilemapRenderer)
+	{
+		tilemapRenderer->Invalidate();
+	}
+	areTargetsLost = false;
+	isDeviceLost = false;
+	Draw(snapshots[readIndex]);
+	return true;
+}
+
+void FrameRenderer::Draw(const RenderSnapshot& snapshot)
+{
+	PROFILE_SCOPE("FrameRenderer::Draw");
+	const auto drawStart = std::chrono::steady_clock::now();
+	SDL_SetRenderDrawColor(renderer, 21, 21, 21, 255);
+	SDL_RenderClear(renderer);
+
+	// The tilemap is below every sprite
+	if (tilemapRenderer)
+	{
+		tilemapRenderer->Render(renderer, assetStore, snapshot.camera);
+	}
+
+	int drawCalls;
+	{
+		PROFILE_SCOPE("SpriteBatch");
+		spriteBatch.Begin(renderer);
+		for (const SpriteDraw& sprite : snapshot.sprites)
+		{
+			// The batch moves the source rectangle to where the image lives in its atlas page
+			spriteBatch.Draw(assetStore->GetTextureRegion(sprite.texture), sprite.srcRect, sprite.dstRect, sprite.rotation);
+		}
+		drawCalls = spriteBatch.End();
+	}
+
+	SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+	for (const SDL_Rect& rect : snapshot.debugRects)
+	{
+		SDL_RenderDrawRect(renderer, &rect);
+	}
+
+	const auto overlayStart = std::chrono::steady_clock::now();
+	for (const OverlayDraw& draw : snapshot.overlayDraws)
+	{
+		SDL_RenderSetClipRect(renderer, &draw.clipRect);
+		SDL_RenderGeometry(renderer, draw.texture, snapshot.overlayVertices.data(), static_cast<int>(snapshot.overlayVertices.size()),
+			snapshot.overlayIndices.data() + draw.firstIndex, draw.numIndices);
+	}
+	if (!snapshot.overlayDraws.empty())
+	{
+		SDL_RenderSetClipRect(renderer, nullptr);
+	}
+	const auto overlayEnd = std::chrono::steady_clock::now();
+
+	{
+		PROFILE_SCOPE("SDL_RenderPresent");
+		SDL_RenderPresent(renderer);
+	}
+
+	std::lock_guard<std::mutex> lock(statsMutex);
+	stats = snapshot.stats;
+	stats.drawCalls = drawCalls;
+	// Presenting is left out, it mostly waits for the vertical blank
+	stats.drawMilliseconds = std::chrono::duration<double, std::milli>(overlayEnd - drawStart).count();
+	stats.overlayMilliseconds = std::chrono::duration<double, std::milli>(overlayEnd - overlayStart).count();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "RenderSnapshot.h"
+#include "SpriteBatch.h"
+#include "../AssetStore/AssetStore.h"
+#include <SDL.h>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+class TilemapRenderer;
+
+/*
+* Draws and presents the latest RenderSnapshot published by the simulation
+* SDL only supports rendering on the thread that owns the window and pumps its events, so drawing stays on the main thread and
+* the simulation runs on a thread of its own in windowed mode.
+* The snapshots are triple buffered: the simulation writes one, one waits as the latest complete frame and the main thread draws
+* the third. Publishing only swaps indices, so the simulation never waits for drawing or for the vertical blank, and a renderer
+* that falls behind simply skips to the newest frame.
+* Headless runs publish and draw on the same thread, one snapshot per frame, so every simulated frame is drawn.
+* The AssetStore and the TilemapRenderer must not change while snapshots are drawn.
+*/
+class FrameRenderer
+{
+private:
+	static const int NUM_SNAPSHOTS = 3;
+
+	SDL_Renderer* renderer;
+	std::unique_ptr<AssetStore>& assetStore;
+	TilemapRenderer* tilemapRenderer;
+
+	RenderSnapshot snapshots[NUM_SNAPSHOTS];
+	int writeIndex = 0;
+	int readyIndex = 1;
+	int readIndex = 2;
+	bool hasNewSnapshot = false;
+
+	std::mutex mutex;
+	std::condition_variable snapshotReady;
+
+	bool areTargetsLost = false;
+	bool isDeviceLost = false;
+	SpriteBatch spriteBatch;
+
+	// Stats of the last frame drawn, read by the simulation for the HUD
+	std::mutex statsMutex;
+	RenderStats stats;
+
+	void Draw(const RenderSnapshot& snapshot);
+
+public:
+	FrameRenderer(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, TilemapRenderer* tilemapRenderer);
+
+	// Snapshot the simulation fills for the current frame, it stays valid until PublishSnapshot()
+	RenderSnapshot& BeginSnapshot();
+	void PublishSnapshot();
+
+	// Draw the newest snapshot not drawn yet, waiting for it at most timeout
+	// Returns false when none was published in time, so the caller can pump the events again
+	bool DrawNextSnapshot(std::chrono::milliseconds timeout);
+
+	// The renderer reset its render targets, the baked tilemap chunks are baked again before the next frame
+	void InvalidateTargets();
+
+	// The renderer reset its device and lost every texture, the assets and the tilemap chunks are created again before the next frame
+	void InvalidateDevice();
+
+	RenderStats GetStats();
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+* Stable LSD radix sort of 64-bit keys, one 8-bit digit per pass, scratch is resized to the size of keys and reused between calls
+* Only the bytes [firstByte, 8) are sorted, keys equal on those bytes keep their order, so low bits that are already in increasing order
+* (such as a submission index) cost no pass. A pass is skipped when every key has the same digit.
+*/
+inline void RadixSort(std::vector<uint64_t>& keys, std::vector<uint64_t>& scratch, int firstByte = 0)
+{
+	const size_t count = keys.size();
+	scratch.resize(count);
+
+	for (int byte = firstByte; byte < 8; byte++)
+	{
+		const int shift = byte * 8;
+		size_t offsets[256] = {};
+		for (uint64_t key : keys)
+		{
+			offsets[(key >> shift) & 0xFF]++;
+		}
+		if (count == 0 || offsets[(keys[0] >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		// Histogram to start offsets
+		size_t offset = 0;
+		for (size_t& bucket : offsets)
+		{
+			const size_t size = bucket;
+			bucket = offset;
+			offset += size;
+		}
+
+		for (uint64_t key : keys)
+		{
+			scratch[offsets[(key >> shift) & 0xFF]++] = key;
+		}
+		keys.swap(scratch);
+	}
+}
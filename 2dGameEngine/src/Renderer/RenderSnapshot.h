@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../AssetStore/TextureHandle.h"
+#include <SDL.h>
+#include <vector>
+
+// Sprites drawn and sprites skipped because they were outside of the camera during a frame
+struct RenderStats
+{
+	int submitted = 0;
+	int culled = 0;
+	int drawCalls = 0;
+	// Texture switches in the order the sprites were gathered and in the sorted order actually drawn
+	int stateChangesBeforeSort = 0;
+	int stateChangesAfterSort = 0;
+	// Time spent drawing the whole frame and the overlay alone, filled in by the FrameRenderer
+	double drawMilliseconds = 0.0;
+	double overlayMilliseconds = 0.0;
+};
+
+// One sprite to draw, in screen space
+struct SpriteDraw
+{
+	TextureHandle texture;
+	// Relative to the image of the texture handle
+	SDL_Rect srcRect;
+	SDL_FRect dstRect;
+	double rotation;
+};
+
+// Part of the overlay sharing a texture and a clip rectangle, drawn from indices [firstIndex, firstIndex + numIndices)
+struct OverlayDraw
+{
+	SDL_Texture* texture;
+	SDL_Rect clipRect;
+	int firstIndex;
+	int numIndices;
+};
+
+/*
+* Everything the FrameRenderer needs to draw a frame, copied out of the registry at the end of the simulation frame
+* Drawing never touches the registry, so the simulation can run the next frame while this one is drawn
+*/
+struct RenderSnapshot
+{
+	SDL_Rect camera = { 0, 0, 0, 0 };
+	// Already culled and in draw order
+	std::vector<SpriteDraw> sprites;
+	// Outlines drawn on top of everything, the colliders in debug mode
+	std::vector<SDL_Rect> debugRects;
+	// Screen space triangles drawn last, the debug HUD
+	std::vector<SDL_Vertex> overlayVertices;
+	std::vector<int> overlayIndices;
+	std::vector<OverlayDraw> overlayDraws;
+	RenderStats stats;
+	int frame = 0;
+
+	// Keeps the capacity so building a snapshot does not allocate once the buffers are warmed up
+	void Clear()
+	{
+		sprites.clear();
+		debugRects.clear();
+		overlayVertices.clear();
+		overlayIndices.clear();
+		overlayDraws.clear();
+		stats = RenderStats();
+	}
+};
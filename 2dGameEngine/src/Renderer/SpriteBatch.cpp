@@ -0,0 +1,85 @@
+#include "SpriteBatch.h"
+#include <glm/glm.hpp>
+#include <cmath>
+
+void SpriteBatch::Begin(SDL_Renderer* renderer)
+{
+	this->renderer = renderer;
+	texture = nullptr;
+	vertices.clear();
+	indices.clear();
+	drawCalls = 0;
+}
+
+void SpriteBatch::Draw(const TextureRegion& region, const SDL_Rect& srcRect, const SDL_FRect& dstRect, double angle, SDL_Color color)
+{
+	if (!region.texture)
+	{
+		return;
+	}
+	if (region.texture != texture)
+	{
+		Flush();
+		texture = region.texture;
+	}
+
+	const glm::vec2 uvMin = region.GetUVMin(srcRect);
+	const glm::vec2 uvMax = region.GetUVMax(srcRect);
+
+	// Corners relative to the center of the destination rectangle, in the order top left, top right, bottom right, bottom left
+	const glm::vec2 halfSize(dstRect.w * 0.5f, dstRect.h * 0.5f);
+	const glm::vec2 center(dstRect.x + halfSize.x, dstRect.y + halfSize.y);
+	const glm::vec2 corners[4] = {
+		glm::vec2(-halfSize.x, -halfSize.y),
+		glm::vec2(halfSize.x, -halfSize.y),
+		glm::vec2(halfSize.x, halfSize.y),
+		glm::vec2(-halfSize.x, halfSize.y)
+	};
+	const glm::vec2 uvs[4] = {
+		glm::vec2(uvMin.x, uvMin.y),
+		glm::vec2(uvMax.x, uvMin.y),
+		glm::vec2(uvMax.x, uvMax.y),
+		glm::vec2(uvMin.x, uvMax.y)
+	};
+
+	// The y axis points down, so a positive angle turns clockwise on screen
+	const float radians = glm::radians(static_cast<float>(angle));
+	const float cos = std::cos(radians);
+	const float sin = std::sin(radians);
+
+	const int first = static_cast<int>(vertices.size());
+	for (int i = 0; i < 4; i++)
+	{
+		const glm::vec2 position = center + glm::vec2(corners[i].x * cos - corners[i].y * sin, corners[i].x * sin + corners[i].y * cos);
+		SDL_Vertex vertex;
+		vertex.position = { position.x, position.y };
+		vertex.color = color;
+		vertex.tex_coord = { uvs[i].x, uvs[i].y };
+		vertices.push_back(vertex);
+	}
+
+	const int quadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+	for (int index : quadIndices)
+	{
+		indices.push_back(first + index);
+	}
+}
+
+void SpriteBatch::Flush()
+{
+	if (indices.empty())
+	{
+		return;
+	}
+	SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size()));
+	drawCalls++;
+	vertices.clear();
+	indices.clear();
+}
+
+int SpriteBatch::End()
+{
+	Flush();
+	texture = nullptr;
+	return drawCalls;
+}
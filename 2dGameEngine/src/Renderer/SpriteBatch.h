@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../AssetStore/AssetStore.h"
+#include <SDL.h>
+#include <vector>
+
+/*
+* Accumulates sprite quads and draws all the consecutive quads of the same texture with a single SDL_RenderGeometry call
+* Rotation is applied on the CPU while building the vertices. The triangles of a call are drawn in order,
+* so sprites keep their draw order inside a batch and a flush is only needed when the texture changes.
+* With the textures packed in atlas pages most frames take one call per page and z-index.
+*/
+class SpriteBatch
+{
+private:
+	SDL_Renderer* renderer = nullptr;
+	SDL_Texture* texture = nullptr;
+	std::vector<SDL_Vertex> vertices;
+	std::vector<int> indices;
+	int drawCalls = 0;
+
+public:
+	SpriteBatch() = default;
+
+	void Begin(SDL_Renderer* renderer);
+
+	/*
+	* Queue a sprite, srcRect is relative to the image of the region and dstRect in screen space
+	* The sprite is rotated by angle degrees clockwise around the center of dstRect, like SDL_RenderCopyEx does
+	*/
+	void Draw(const TextureRegion& region, const SDL_Rect& srcRect, const SDL_FRect& dstRect, double angle, SDL_Color color = { 255, 255, 255, 255 });
+
+	// Submit the queued quads
+	void Flush();
+
+	// Flush and return the number of SDL_RenderGeometry calls since Begin()
+	int End();
+};
@@ -1,12 +1,23 @@
 #pragma once
 
 #include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
 #include "../Components/AnimationComponent.h"
 #include "../Components/SpriteComponent.h"
-#include <SDL.h>
 
 class AnimationSystem : public System
 {
+private:
+	// Game time of the last Update() in milliseconds, 64 bits so a server running for weeks never wraps
+	Uint64 currentTime = 0;
+
+protected:
+	void OnEntityAdded(Entity entity) override
+	{
+		// Animations start when their entity joins the simulation
+		entity.GetComponent<AnimationComponent>().startTime = currentTime;
+	}
+
 public:
 	AnimationSystem()
 	{
@@ -14,8 +25,11 @@ public:
 		RequireComponent<AnimationComponent>();
 	}
 
-	void Update()
+	// currentTime is the game time in milliseconds, it only advances with the simulation ticks so the animations never read the wall clock
+	void Update(Uint64 currentTime)
 	{
+		PROFILE_SCOPE("AnimationSystem::Update");
+		this->currentTime = currentTime;
 		for (auto entity : GetSystemEntities())
 		{
 			auto& animation = entity.GetComponent<AnimationComponent>();
@@ -23,7 +37,8 @@ public:
 
 			/// Current frame = (Time since animation started * Frame rate  = # frames since animation started) % numFrames
 
-			animation.currentFrame = ((SDL_GetTicks() - animation.startTime) * animation.frameSpeedRate / 1000) % animation.numFrames;
+			const Uint64 elapsed = currentTime - animation.startTime;
+			animation.currentFrame = static_cast<int>((elapsed * animation.frameSpeedRate / 1000) % animation.numFrames);
 			sprite.srcRect.x = animation.currentFrame * sprite.width;
 
 		}
@@ -2,6 +2,7 @@
 
 #include <SDL.h>
 #include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
 #include "../Components/CameraFollowComponent.h"
 #include "../Components/TransformComponent.h"
 
@@ -16,6 +17,7 @@ public:
 
 	void Update(SDL_Rect& camera)
 	{
+		PROFILE_SCOPE("CameraMovementSystem::Update");
 		for (auto entity : GetSystemEntities())
 		{
 			auto transform = entity.GetComponent<TransformComponent>();
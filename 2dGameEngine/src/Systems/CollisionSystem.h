@@ -1,76 +1,464 @@
 #pragma once
 
 #include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
 #include "../EventBus/EventBus.h"
-#include "../Events/CollisionEvent.h"
+#include "../Events/CollisionEnterEvent.h"
+#include "../Events/CollisionStayEvent.h"
+#include "../Events/CollisionExitEvent.h"
+#include "../Events/TilemapCollisionEvent.h"
 #include "../Components/BoxColliderComponent.h"
 #include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Collision/AABB.h"
+#include "../Collision/IBroadphase.h"
+#include "../Collision/CollisionLayers.h"
+#include "../Collision/AABBBatch.h"
+#include "../Collision/SweptAABB.h"
+#include "../Collision/SpatialHashGrid.h"
+#include "../Collision/SweepAndPrune.h"
+#include "../Collision/DynamicTreeBroadphase.h"
+#include "../Collision/TilemapCollider.h"
+#include "../ThreadPool/ThreadPool.h"
+#include <algorithm>
+
+// Result of CollisionSystem::Raycast()
+struct RaycastHit
+{
+	Entity entity;
+	// Part of the segment before the hit, in [0, 1]
+	float fraction = 0.0f;
+	glm::vec2 point = glm::vec2(0, 0);
+	// Face of the collider that was hit, zero when the segment starts inside the collider
+	glm::vec2 normal = glm::vec2(0, 0);
+};
 
 class CollisionSystem : public System
 {
+private:
+	// Broadphase, only the candidate pairs it returns reach the AABB test
+	std::unique_ptr<IBroadphase> broadphase;
+	BroadphaseType broadphaseType;
+	float cellSize;
+	std::vector<std::pair<int, int>> candidatePairs;
+	CollisionLayerMatrix layerMatrix;
+
+
+	// Bounds of every collider at the end of the frame and, for continuous colliders, the movement done during the frame
+	// [Vector index = entity id]
+	struct ColliderMotion
+	{
+		AABB aabb;
+		glm::vec2 displacement;
+		bool isContinuous;
+	};
+	std::vector<ColliderMotion> motions;
+
+	// Contact cache, the overlapping pairs of the current and previous frame sorted by ContactKey()
+	struct Contact
+	{
+		long long key;
+		Entity a;
+		Entity b;
+		float timeOfImpact;
+		glm::vec2 normal;
+	};
+	std::vector<Contact> contacts;
+	std::vector<Contact> previousContacts;
+	bool emitStayEvents = false;
+
+	// Bus of the last Update(), the exits of removed entities are emitted on it as soon as they leave the system
+	EventBus* eventBus = nullptr;
+
+	// Candidate pairs per narrowphase task, large enough to be worth handing to another thread
+	static const size_t NARROWPHASE_CHUNK_SIZE = 256;
+
+	// Scratch of one narrowphase task, the batch holds the boxes of the candidates of one collider for the SIMD test
+	struct NarrowphaseChunk
+	{
+		AABBBatch batch;
+		std::vector<Contact> contacts;
+	};
+	std::vector<NarrowphaseChunk> narrowphaseChunks;
+	std::vector<size_t> chunkStarts;
+
+	// Solid terrain of the level, tested directly against the moving colliders instead of going through the broadphase
+	std::shared_ptr<TilemapCollider> tilemapCollider;
+	struct TilemapContact
+	{
+		Entity entity;
+		TileContact contact;
+	};
+	std::vector<TilemapContact> tilemapContacts;
+
+	// Entity of every collider in the broadphase, to turn the proxy ids back into entities
+	// [Vector index = entity id]
+	std::vector<Entity> colliderEntities;
+
+	// Copies the entities reported by a broadphase query into the caller buffer, optionally keeping only the ones touching a circle
+	struct EntityCollector : public IQueryCallback
+	{
+		const CollisionSystem& system;
+		Entity* results;
+		int maxResults;
+		int count = 0;
+		bool isCircle = false;
+		glm::vec2 center = glm::vec2(0, 0);
+		float radius = 0.0f;
+
+		EntityCollector(const CollisionSystem& system, Entity* results, int maxResults) : system(system), results(results), maxResults(maxResults)
+		{
+
+		}
+
+		bool Report(int id) override
+		{
+			if (isCircle)
+			{
+				// Distance from the center to the closest point of the box
+				const AABB& aabb = system.broadphase->GetAABB(id);
+				const glm::vec2 closest = glm::clamp(center, aabb.min, aabb.max);
+				const glm::vec2 offset = center - closest;
+				if (offset.x * offset.x + offset.y * offset.y > radius * radius)
+				{
+					return true;
+				}
+			}
+			results[count++] = system.colliderEntities[id];
+			return count < maxResults;
+		}
+	};
+
+protected:
+	void OnEntityRemoved(Entity entity) override
+	{
+		broadphase->Remove(entity.GetId());
+
+		/*
+		* The contacts of the entity end now, while its components can still be read
+		* Left in the cache they would exit next frame with a dead entity, and an entity reusing the id would never enter the same pairs
+		* The partition keeps the remaining contacts sorted by ContactKey()
+		*/
+		auto removed = std::stable_partition(previousContacts.begin(), previousContacts.end(), [&entity](const Contact& contact)
+			{
+				return contact.a != entity && contact.b != entity;
+			});
+		if (eventBus)
+		{
+			for (auto contact = removed; contact != previousContacts.end(); contact++)
+			{
+				eventBus->EmitEvent<CollisionExitEvent>(contact->a, contact->b);
+			}
+		}
+		previousContacts.erase(removed, previousContacts.end());
+	}
+
 public:
-	CollisionSystem()
+	CollisionSystem(BroadphaseType broadphaseType = BROADPHASE_SPATIAL_HASH, float cellSize = 128.0f) : cellSize(cellSize)
 	{
 		RequireComponent<BoxColliderComponent>();
 		RequireComponent<TransformComponent>();
+		SetBroadphase(broadphaseType);
 	}
 
-	void Update(std::unique_ptr<EventBus>& eventBus)
+	/*
+	* Select the broadphase, usually once per level
+	* BROADPHASE_SPATIAL_HASH is the best choice when the colliders have similar sizes, BROADPHASE_SWEEP_AND_PRUNE when they vary a lot
+	* and BROADPHASE_DYNAMIC_TREE when most colliders are static level geometry
+	* The colliders are added to the new broadphase on the next Update()
+	*/
+	void SetBroadphase(BroadphaseType type)
 	{
-		auto entities = GetSystemEntities();
+		switch (type)
+		{
+		case BROADPHASE_SWEEP_AND_PRUNE:
+			broadphase = std::make_unique<SweepAndPrune>();
+			break;
+		case BROADPHASE_DYNAMIC_TREE:
+			broadphase = std::make_unique<DynamicTreeBroadphase>();
+			break;
+		case BROADPHASE_SPATIAL_HASH:
+		default:
+			broadphase = std::make_unique<SpatialHashGrid>(cellSize);
+			break;
+		}
+		broadphaseType = type;
+	}
 
-		// Loop all entities that the system is interested in
-		for (auto i = entities.begin(); i != entities.end(); i++)
+	BroadphaseType GetBroadphaseType() const
+	{
+		return broadphaseType;
+	}
+
+	// Cell size of the spatial hash broadphase, it should be close to the size of the typical collider of the level
+	void SetCellSize(float cellSize)
+	{
+		this->cellSize = cellSize;
+		if (broadphaseType == BROADPHASE_SPATIAL_HASH)
 		{
-			Entity a = *i;
-			auto aTransform = a.GetComponent<TransformComponent>();
-			auto aCollider = a.GetComponent<BoxColliderComponent>();
+			static_cast<SpatialHashGrid*>(broadphase.get())->SetCellSize(cellSize);
+		}
+	}
 
-			// Loop all the entities that still need to be checked
-			for (auto j = i; j != entities.end(); j++)
+	// Stay events are off by default, so settled contacts emit nothing
+	void SetEmitStayEvents(bool emitStayEvents)
+	{
+		this->emitStayEvents = emitStayEvents;
+	}
+
+	// Canonical key of a pair, the same for (a, b) and (b, a)
+	static long long ContactKey(int a, int b)
+	{
+		return (static_cast<long long>(std::min(a, b)) << 32) | static_cast<unsigned int>(std::max(a, b));
+	}
+
+	// Configure which layers collide with each other
+	CollisionLayerMatrix& GetLayerMatrix()
+	{
+		return layerMatrix;
+	}
+
+	// Terrain of the level, nullptr removes it
+	void SetTilemapCollider(std::shared_ptr<TilemapCollider> tilemapCollider)
+	{
+		this->tilemapCollider = tilemapCollider;
+	}
+
+	void Update(std::unique_ptr<EventBus>& eventBus, double deltaTime, std::unique_ptr<ThreadPool>& threadPool)
+	{
+		PROFILE_SCOPE("CollisionSystem::Update");
+		this->eventBus = eventBus.get();
+		const auto& entities = GetSystemEntities();
+		tilemapContacts.clear();
+
+		// Refresh the bounds of every collider in the broadphase
+		for (int i = 0; i < static_cast<int>(entities.size()); i++)
+		{
+			const Entity& entity = entities[i];
+			const auto& transform = entity.GetComponent<TransformComponent>();
+			const auto& collider = entity.GetComponent<BoxColliderComponent>();
+
+			if (entity.GetId() >= static_cast<int>(colliderEntities.size()))
 			{
-				Entity b = *j;
+				colliderEntities.resize(entity.GetId() + 1);
+				motions.resize(entity.GetId() + 1);
+			}
+			colliderEntities[entity.GetId()] = entity;
+
+			// The MovementSystem already ran, so continuous colliders moved from (position - displacement) to position during this frame
+			ColliderMotion& motion = motions[entity.GetId()];
+			const glm::vec2 min = transform.position + collider.offset;
+			motion.aabb = AABB(min, min + glm::vec2(collider.width, collider.height));
+			motion.isContinuous = collider.isContinuous && !collider.isStatic && entity.HasComponent<RigidBodyComponent>();
+			motion.displacement = motion.isContinuous ? entity.GetComponent<RigidBodyComponent>().velocity * static_cast<float>(deltaTime) : glm::vec2(0, 0);
 
-				// Bypass if we are trying to test the same entity
-				if (a == b)
+			// Colliders on layers that collide with nothing never enter the broadphase
+			const uint32_t mask = collider.mask & layerMatrix.GetMask(collider.layer);
+			if (mask == 0)
+			{
+				broadphase->Remove(entity.GetId());
+			}
+			else
+			{
+				// Continuous colliders enter the broadphase with the box covering their whole movement
+				const AABB bounds = motion.isContinuous ? SweptBounds(motion.aabb, motion.displacement) : motion.aabb;
+				broadphase->InsertOrUpdate(entity.GetId(), bounds, collider.isStatic, collider.layer, mask);
+			}
+
+			// Only moving colliders can run into the terrain, it only looks at the cells under the collider
+			if (tilemapCollider && !collider.isStatic)
+			{
+				const uint32_t terrainLayer = tilemapCollider->GetLayer();
+				TileContact contact;
+				if (ShouldCollide(collider.layer, mask, terrainLayer, layerMatrix.GetMask(terrainLayer)) && tilemapCollider->Collide(motion.aabb, contact))
 				{
-					continue;
+					tilemapContacts.push_back({ entity, contact });
 				}
+			}
+		}
 
-				auto bTransform = b.GetComponent<TransformComponent>();
-				auto bCollider = b.GetComponent<BoxColliderComponent>();
-
-				// Perform AABB collision check
-				bool collisionHappened = CheckAABBCollision(
-					aTransform.position.x + aCollider.offset.x,
-					aTransform.position.y + aCollider.offset.y,
-					aCollider.width,
-					aCollider.height,
-					bTransform.position.x + bCollider.offset.x,
-					bTransform.position.y + bCollider.offset.y,
-					bCollider.width,
-					bCollider.height
-				);
-
-				if (collisionHappened)
-				{
-					Logger::Log("Entity " + std::to_string(a.GetId()) + " is colliding with entity " + std::to_string(b.GetId()));
-					eventBus->EmitEvent<CollisionEvent>(a, b);
+		candidatePairs.clear();
+		broadphase->FindPairs(candidatePairs);
 
-				}
+		// Sorting groups the candidates of each collider together and leaves the contacts sorted by ContactKey()
+		std::sort(candidatePairs.begin(), candidatePairs.end());
 
+		// Split the candidates into chunks that never cut the candidates of a collider in two
+		// The chunks only depend on the candidate pairs, so the result is the same for any number of threads
+		chunkStarts.clear();
+		size_t pairIndex = 0;
+		while (pairIndex < candidatePairs.size())
+		{
+			chunkStarts.push_back(pairIndex);
+			pairIndex = std::min(pairIndex + NARROWPHASE_CHUNK_SIZE, candidatePairs.size());
+			while (pairIndex < candidatePairs.size() && candidatePairs[pairIndex].first == candidatePairs[pairIndex - 1].first)
+			{
+				pairIndex++;
 			}
 		}
+		chunkStarts.push_back(candidatePairs.size());
+
+		const int numChunks = static_cast<int>(chunkStarts.size()) - 1;
+		if (static_cast<int>(narrowphaseChunks.size()) < numChunks)
+		{
+			narrowphaseChunks.resize(numChunks);
+		}
 
+		// Every chunk writes its contacts into its own buffer
+		threadPool->ParallelFor(numChunks, [&](int chunk)
+			{
+				Narrowphase(chunkStarts[chunk], chunkStarts[chunk + 1], narrowphaseChunks[chunk]);
+			});
+
+		// The candidates are sorted, so concatenating the chunks in order yields the contacts sorted by ContactKey()
+		contacts.clear();
+		for (int chunk = 0; chunk < numChunks; chunk++)
+		{
+			const auto& chunkContacts = narrowphaseChunks[chunk].contacts;
+			contacts.insert(contacts.end(), chunkContacts.begin(), chunkContacts.end());
+		}
+
+		EmitContactEvents(eventBus);
+		std::swap(contacts, previousContacts);
+
+		for (const auto& tilemapContact : tilemapContacts)
+		{
+			eventBus->EmitEvent<TilemapCollisionEvent>(tilemapContact.entity, tilemapContact.contact.normal, tilemapContact.contact.penetration);
+		}
+	}
+
+	/*
+	* Spatial queries on the colliders as of the last Update(), gameplay code uses them instead of looping over every entity
+	* The entities are written into the caller buffer, up to maxResults of them, and the number written is returned.
+	* Only colliders whose layer is in the mask are returned. Continuous colliders are found by the bounds of their whole last movement
+	* and colliders on layers that collide with nothing are not in the broadphase, so they are never found.
+	*/
+	int QueryAABB(const AABB& aabb, uint32_t mask, Entity* results, int maxResults) const
+	{
+		if (maxResults <= 0)
+		{
+			return 0;
+		}
+		EntityCollector collector(*this, results, maxResults);
+		broadphase->Query(aabb, mask, collector);
+		return collector.count;
+	}
+
+	int QueryRadius(glm::vec2 center, float radius, uint32_t mask, Entity* results, int maxResults) const
+	{
+		if (maxResults <= 0)
+		{
+			return 0;
+		}
+		EntityCollector collector(*this, results, maxResults);
+		collector.isCircle = true;
+		collector.center = center;
+		collector.radius = radius;
+		broadphase->Query(AABB(center - glm::vec2(radius, radius), center + glm::vec2(radius, radius)), mask, collector);
+		return collector.count;
 	}
 
-	bool CheckAABBCollision(double aX, double aY, double aW, double aH, double bX, double bY, double bW, double bH)
+	int QueryPoint(glm::vec2 point, uint32_t mask, Entity* results, int maxResults) const
 	{
-		return (
-			aX < bX + bW &&
-			aX + aW > bX &&
-			aY < bY + bH &&
-			aY + aH > bY
-		);
+		return QueryAABB(AABB(point, point), mask, results, maxResults);
+	}
+
+	// Closest collider crossed by the segment from start to end, returns false if there is none
+	bool Raycast(glm::vec2 start, glm::vec2 end, uint32_t mask, RaycastHit& hit) const
+	{
+		int id;
+		if (!broadphase->Raycast(start, end, mask, id, hit.fraction, hit.normal))
+		{
+			return false;
+		}
+		hit.entity = colliderEntities[id];
+		hit.point = start + (end - start) * hit.fraction;
+		return true;
+	}
+
+	/*
+	* Narrowphase on the candidate pairs [begin, end), one collider against a batch of its candidates at a time
+	* Only reads the data gathered by Update(), so chunks can run on different threads
+	*/
+	void Narrowphase(size_t begin, size_t end, NarrowphaseChunk& chunk) const
+	{
+		AABBBatch& batch = chunk.batch;
+		chunk.contacts.clear();
+
+		size_t runStart = begin;
+		while (runStart < end)
+		{
+			const int a = candidatePairs[runStart].first;
+			size_t runEnd = runStart;
+			batch.Clear();
+			while (runEnd < end && candidatePairs[runEnd].first == a)
+			{
+				batch.Add(broadphase->GetAABB(candidatePairs[runEnd].second));
+				runEnd++;
+			}
+
+			const AABB& aBox = broadphase->GetAABB(a);
+			for (int first = 0; first < batch.Size(); first += AABB_BATCH_WIDTH)
+			{
+				const int count = std::min(AABB_BATCH_WIDTH, batch.Size() - first);
+				uint32_t hits = OverlapAABBBatch(aBox, batch, first, count);
+
+				while (hits != 0)
+				{
+					const int b = candidatePairs[runStart + first + std::countr_zero(hits)].second;
+					hits &= hits - 1;
+
+					float timeOfImpact = 1.0f;
+					glm::vec2 normal(0, 0);
+					if (motions[a].isContinuous || motions[b].isContinuous)
+					{
+						// The swept bounds overlap, find if and when the boxes actually met during the frame
+						const ColliderMotion& aMotion = motions[a];
+						const ColliderMotion& bMotion = motions[b];
+						const AABB aStart(aMotion.aabb.min - aMotion.displacement, aMotion.aabb.max - aMotion.displacement);
+						const AABB bStart(bMotion.aabb.min - bMotion.displacement, bMotion.aabb.max - bMotion.displacement);
+						if (!SweepAABB(aStart, aMotion.displacement - bMotion.displacement, bStart, timeOfImpact, normal))
+						{
+							continue;
+						}
+					}
+
+					chunk.contacts.push_back({ ContactKey(a, b), colliderEntities[a], colliderEntities[b], timeOfImpact, normal });
+				}
+			}
+			runStart = runEnd;
+		}
+	}
+
+	/*
+	* Diff the sorted contacts of this frame against the previous frame in a single linear merge
+	* Pairs only in the new list entered, pairs only in the old list exited and pairs in both stayed
+	*/
+	void EmitContactEvents(std::unique_ptr<EventBus>& eventBus)
+	{
+		size_t i = 0;
+		size_t j = 0;
+		while (i < contacts.size() || j < previousContacts.size())
+		{
+			if (j == previousContacts.size() || (i < contacts.size() && contacts[i].key < previousContacts[j].key))
+			{
+				eventBus->EmitEvent<CollisionEnterEvent>(contacts[i].a, contacts[i].b, contacts[i].timeOfImpact, contacts[i].normal);
+				i++;
+			}
+			else if (i == contacts.size() || previousContacts[j].key < contacts[i].key)
+			{
+				eventBus->EmitEvent<CollisionExitEvent>(previousContacts[j].a, previousContacts[j].b);
+				j++;
+			}
+			else
+			{
+				if (emitStayEvents)
+				{
+					eventBus->EmitEvent<CollisionStayEvent>(contacts[i].a, contacts[i].b);
+				}
+				i++;
+				j++;
+			}
+		}
 	}
-};
\ No newline at end of file
+};
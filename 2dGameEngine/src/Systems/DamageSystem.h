@@ -1,9 +1,10 @@
 #pragma once
 
 #include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
 #include "../Components/BoxColliderComponent.h"
 #include "../EventBus/EventBus.h"
-#include "../Events/CollisionEvent.h"
+#include "../Events/CollisionEnterEvent.h"
 
 class DamageSystem : public System
 {
@@ -15,10 +16,10 @@ public:
 
 	void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus)
 	{
-		eventBus->SubscribeToEvent<CollisionEvent>(this, &DamageSystem::onCollision);
+		eventBus->SubscribeToEvent<CollisionEnterEvent>(this, &DamageSystem::onCollision);
 	}
 
-	void onCollision(CollisionEvent& event)
+	void onCollision(CollisionEnterEvent& event)
 	{
 		Logger::Log("Damage system received an event collision between entities " + std::to_string(event.a.GetId()) + " and " + std::to_string(event.b.GetId()));
 		event.a.Kill();
@@ -27,6 +28,6 @@ public:
 
 	void Update()
 	{
-
+		PROFILE_SCOPE("DamageSystem::Update");
 	}
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
 #include "../EventBus/EventBus.h"
 #include "../Components/KeyboardControlledComponent.h"
 #include "../Components/SpriteComponent.h"
@@ -58,6 +59,6 @@ public:
 
 	void Update()
 	{
-
+		PROFILE_SCOPE("KeyboardControlSystem::Update");
 	}
 };
\ No newline at end of file
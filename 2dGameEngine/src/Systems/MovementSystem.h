@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/RigidBodyComponent.h"
 
@@ -15,6 +16,7 @@ public:
 
 	void Update(double deltaTime)
 	{
+		PROFILE_SCOPE("MovementSystem::Update");
 		//  Loop all the entities that the system is interested in
 		for (auto entity : GetSystemEntities())
 		{
@@ -22,6 +24,9 @@ public:
 			TransformComponent& transform = entity.GetComponent<TransformComponent>();
 			const RigidBodyComponent rigidbody = entity.GetComponent<RigidBodyComponent>();
 
+			transform.previousPosition = transform.position;
+			transform.previousRotation = transform.rotation;
+
 			transform.position.x += rigidbody.velocity.x * deltaTime;
 			transform.position.y += rigidbody.velocity.y * deltaTime;
 
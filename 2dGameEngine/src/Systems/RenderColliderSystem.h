@@ -1,8 +1,10 @@
 #pragma once
 
 #include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/BoxColliderComponent.h"
+#include "../Renderer/RenderSnapshot.h"
 #include <SDL.h>
 
 class RenderColliderSystem : public System
@@ -14,8 +16,10 @@ public:
 		RequireComponent<BoxColliderComponent>();
 	}
 
-	void Update(SDL_Renderer* renderer, SDL_Rect& camera)
+	// Add the outline of every collider to the snapshot
+	void Update(RenderSnapshot& snapshot, const SDL_Rect& camera)
 	{
+		PROFILE_SCOPE("RenderColliderSystem::Update");
 		for (auto entity : GetSystemEntities())
 		{
 			const auto transform = entity.GetComponent<TransformComponent>();
@@ -29,8 +33,7 @@ public:
 				static_cast<int>(collider.width * transform.scale.x),
 				static_cast<int>(collider.height * transform.scale.y)
 			};
-			SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-			SDL_RenderDrawRect(renderer, &colliderRect);
+			snapshot.debugRects.push_back(colliderRect);
 
 		}
 	}
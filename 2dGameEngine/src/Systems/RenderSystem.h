@@ -1,14 +1,215 @@
 #pragma once
 
 #include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../AssetStore/AssetStore.h"
+#include "../Collision/AABB.h"
+#include "../Collision/SpatialHashGrid.h"
+#include "../Renderer/RenderSnapshot.h"
+#include "../Renderer/RadixSort.h"
 #include <SDL.h>
 #include <algorithm>
+#include <cmath>
+#include <map>
 
 class RenderSystem : public System
 {
+private:
+	// Cell size of the grids of static sprites, a couple of scaled tiles
+	static constexpr float STATIC_SPRITE_CELL_SIZE = 256.0f;
+
+	/*
+	* One z-index of the render queue
+	* Sprites flagged isStatic never move, so they are binned once in a grid and only the ones under the camera are visited.
+	* Moving sprites and the isFixed UI sprites are kept in a list and tested one by one.
+	*/
+	struct RenderLayer
+	{
+		// Sorted by id
+		std::vector<Entity> dynamicSprites;
+		SpatialHashGrid staticSprites = SpatialHashGrid(STATIC_SPRITE_CELL_SIZE);
+		int numStaticSprites = 0;
+	};
+
+	/*
+	* Persistent render queue, one bucket per z-index drawn in increasing z order
+	* Entities only move between buckets when they are added, removed or change their z-index, so the order is never sorted again every frame
+	* [Map key = z-index]
+	*/
+	std::map<int, RenderLayer> layers;
+
+	struct QueuedSprite
+	{
+		Entity entity;
+		int zIndex = 0;
+		bool isStatic = false;
+	};
+	// [Vector index = entity id]
+	std::vector<QueuedSprite> queuedSprites;
+
+	// Entities whose sprite z-index was changed directly, they are moved to their new bucket after drawing
+	std::vector<Entity> dirtyEntities;
+
+	// Static sprites of a layer found under the camera, sorted by id before drawing
+	struct VisibleSprites : public IQueryCallback
+	{
+		std::vector<int> ids;
+
+		bool Report(int id) override
+		{
+			ids.push_back(id);
+			return true;
+		}
+	};
+	VisibleSprites visibleSprites;
+
+	RenderStats stats;
+
+	// Visible sprites of the frame, drawn in the order of their sort keys
+	struct DrawCommand
+	{
+		Entity entity;
+		// Same index for every sprite drawn from the same texture
+		int textureIndex;
+	};
+	std::vector<DrawCommand> drawCommands;
+
+	/*
+	* 64-bit sort key of a draw, from the most to the least significant bits:
+	* z-index (16 bits) | fixed (1 bit) | texture (15 bits) | index of the draw command (32 bits)
+	* Inside a z-index the world sprites come before the UI and the sprites sharing an atlas page end up next to each other
+	*/
+	std::vector<uint64_t> sortKeys;
+	std::vector<uint64_t> sortScratch;
+
+	static uint64_t MakeSortKey(int zIndex, bool isFixed, int texture, size_t index)
+	{
+		const uint64_t z = static_cast<uint64_t>(std::clamp(zIndex, -32768, 32767) + 32768);
+		const uint64_t fixed = isFixed ? 1 : 0;
+		const uint64_t textureBits = static_cast<uint64_t>(std::clamp(texture, 0, 0x7FFF));
+		return (z << 48) | (fixed << 47) | (textureBits << 32) | static_cast<uint64_t>(index);
+	}
+
+	void Enqueue(Entity entity, int zIndex)
+	{
+		if (entity.GetId() >= static_cast<int>(queuedSprites.size()))
+		{
+			queuedSprites.resize(entity.GetId() + 1);
+		}
+
+		const auto& sprite = entity.GetComponent<SpriteComponent>();
+		QueuedSprite& queued = queuedSprites[entity.GetId()];
+		queued.entity = entity;
+		queued.zIndex = zIndex;
+		queued.isStatic = sprite.isStatic && !sprite.isFixed;
+
+		auto& layer = layers[zIndex];
+		if (queued.isStatic)
+		{
+			layer.staticSprites.InsertOrUpdate(entity.GetId(), GetSpriteBounds(entity.GetComponent<TransformComponent>(), sprite), true, 1, 1);
+			layer.numStaticSprites++;
+		}
+		else
+		{
+			layer.dynamicSprites.insert(std::lower_bound(layer.dynamicSprites.begin(), layer.dynamicSprites.end(), entity), entity);
+		}
+	}
+
+	void Dequeue(Entity entity)
+	{
+		const QueuedSprite& queued = queuedSprites[entity.GetId()];
+		auto layer = layers.find(queued.zIndex);
+		if (layer == layers.end())
+		{
+			return;
+		}
+
+		RenderLayer& renderLayer = layer->second;
+		if (queued.isStatic)
+		{
+			renderLayer.staticSprites.Remove(entity.GetId());
+			renderLayer.numStaticSprites--;
+		}
+		else
+		{
+			auto& entities = renderLayer.dynamicSprites;
+			auto it = std::lower_bound(entities.begin(), entities.end(), entity);
+			if (it != entities.end() && *it == entity)
+			{
+				entities.erase(it);
+			}
+		}
+
+		if (renderLayer.dynamicSprites.empty() && renderLayer.numStaticSprites == 0)
+		{
+			layers.erase(layer);
+		}
+	}
+
+	void SubmitSprite(std::unique_ptr<AssetStore>& assetStore, Entity entity, int zIndex)
+	{
+		const SpriteComponent& sprite = entity.GetComponent<SpriteComponent>();
+
+		// The z-index was changed without SetZIndex(), the sprite is drawn in the right bucket from the next frame
+		if (sprite.zIndex != zIndex)
+		{
+			dirtyEntities.push_back(entity);
+		}
+
+		const int textureIndex = assetStore->GetTextureSortIndex(sprite.texture);
+		sortKeys.push_back(MakeSortKey(zIndex, sprite.isFixed, textureIndex, drawCommands.size()));
+		drawCommands.push_back({ entity, textureIndex });
+	}
+
+	void AddToSnapshot(RenderSnapshot& snapshot, const DrawCommand& command, const SDL_Rect& camera, float alpha)
+	{
+		const TransformComponent& transform = command.entity.GetComponent<TransformComponent>();
+		const SpriteComponent& sprite = command.entity.GetComponent<SpriteComponent>();
+
+		// Set the destination rectangle with the x,y position to be rendered, between the last two simulation ticks
+		const glm::vec2 position = glm::mix(transform.previousPosition, transform.position, alpha);
+		const double rotation = transform.previousRotation + (transform.rotation - transform.previousRotation) * alpha;
+		SDL_FRect dstRect = {
+			position.x - (sprite.isFixed ? 0 : camera.x),
+			position.y - (sprite.isFixed ? 0 : camera.y),
+			sprite.width * transform.scale.x,
+			sprite.height * transform.scale.y
+		};
+
+		snapshot.sprites.push_back({ sprite.texture, sprite.srcRect, dstRect, rotation });
+		stats.submitted++;
+	}
+
+	// Number of times the texture changes between two consecutive draws of the given order
+	int CountStateChanges(bool isSorted) const
+	{
+		int changes = 0;
+		int texture = -1;
+		for (size_t i = 0; i < drawCommands.size(); i++)
+		{
+			const size_t index = isSorted ? static_cast<size_t>(sortKeys[i] & 0xFFFFFFFF) : i;
+			if (drawCommands[index].textureIndex != texture)
+			{
+				texture = drawCommands[index].textureIndex;
+				changes++;
+			}
+		}
+		return changes;
+	}
+
+protected:
+	void OnEntityAdded(Entity entity) override
+	{
+		Enqueue(entity, entity.GetComponent<SpriteComponent>().zIndex);
+	}
+
+	void OnEntityRemoved(Entity entity) override
+	{
+		Dequeue(entity);
+	}
+
 public:
 	RenderSystem()
 	{
@@ -16,62 +217,115 @@ public:
 		RequireComponent<SpriteComponent>();
 	}
 
-	void Update(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, SDL_Rect& camera)
+	// World space box covered by a sprite, SDL_RenderCopyEx rotates around the center of the destination rectangle
+	static AABB GetSpriteBounds(const TransformComponent& transform, const SpriteComponent& sprite)
 	{
-		// Currently we are sorting entity array at every frame but in future we might want to group the arrays differently to make this more performant
-		
-		// Create a vecror with both Sprite and Transform component of all entities
-		struct RenderableEntity
+		const glm::vec2 halfSize(sprite.width * transform.scale.x * 0.5f, sprite.height * transform.scale.y * 0.5f);
+		const glm::vec2 center = transform.position + halfSize;
+		if (transform.rotation == 0.0)
 		{
-			TransformComponent transformComponent;
-			SpriteComponent spriteComponent;
+			return AABB(transform.position, transform.position + halfSize * 2.0f);
+		}
 
-		};
-		std::vector<RenderableEntity> renderableEntities;
+		const float radians = glm::radians(static_cast<float>(transform.rotation));
+		const float cos = std::abs(std::cos(radians));
+		const float sin = std::abs(std::sin(radians));
+		const glm::vec2 rotatedHalfSize(halfSize.x * cos + halfSize.y * sin, halfSize.x * sin + halfSize.y * cos);
+		return AABB(center - rotatedHalfSize, center + rotatedHalfSize);
+	}
 
-		for (auto entity : GetSystemEntities())
+	// Change the z-index of a sprite and move it to its new bucket right away
+	void SetZIndex(Entity entity, int zIndex)
+	{
+		auto& sprite = entity.GetComponent<SpriteComponent>();
+		if (sprite.zIndex == zIndex)
+		{
+			return;
+		}
+		Dequeue(entity);
+		sprite.zIndex = zIndex;
+		Enqueue(entity, zIndex);
+	}
+
+	// Bin a static sprite again after its transform was changed, otherwise it is culled at its old bounds
+	void MoveStaticSprite(Entity entity)
+	{
+		const QueuedSprite& queued = queuedSprites[entity.GetId()];
+		if (!queued.isStatic)
 		{
-			RenderableEntity renderableEntity;
-			renderableEntity.spriteComponent = entity.GetComponent<SpriteComponent>();
-			renderableEntity.transformComponent = entity.GetComponent<TransformComponent>();
-			renderableEntities.emplace_back(renderableEntity);
+			return;
 		}
+		const AABB bounds = GetSpriteBounds(entity.GetComponent<TransformComponent>(), entity.GetComponent<SpriteComponent>());
+		layers[queued.zIndex].staticSprites.InsertOrUpdate(entity.GetId(), bounds, true, 1, 1);
+	}
+
+	const RenderStats& GetStats() const
+	{
+		return stats;
+	}
+
+	/*
+	* Cull and sort the sprites, and write them in draw order into the snapshot for the FrameRenderer
+	* alpha is the fraction of a tick elapsed since the last simulation tick, the sprites are interpolated from their previous transform by it
+	*/
+	void Update(RenderSnapshot& snapshot, std::unique_ptr<AssetStore>& assetStore, const SDL_Rect& camera, float alpha)
+	{
+		PROFILE_SCOPE("RenderSystem::Update");
+		stats = RenderStats();
+		drawCommands.clear();
+		sortKeys.clear();
+		const AABB view(glm::vec2(camera.x, camera.y), glm::vec2(camera.x + camera.w, camera.y + camera.h));
 
-		// Sort the vector by z-index value
-		std::sort(renderableEntities.begin(), renderableEntities.end(), [](const RenderableEntity& a, const RenderableEntity& b)
+		// Gather the visible sprites, bucket by bucket
+		for (auto& layer : layers)
+		{
+			RenderLayer& renderLayer = layer.second;
+
+			visibleSprites.ids.clear();
+			renderLayer.staticSprites.Query(view, 1, visibleSprites);
+			std::sort(visibleSprites.ids.begin(), visibleSprites.ids.end());
+			stats.culled += renderLayer.numStaticSprites - static_cast<int>(visibleSprites.ids.size());
+
+			// Merge the visible static sprites with the moving ones in entity id order, the order of the sprites with equal sort keys
+			size_t i = 0;
+			for (const Entity& entity : renderLayer.dynamicSprites)
 			{
-				return a.spriteComponent.zIndex < b.spriteComponent.zIndex;
-			});
-
-		//  Loop all the entities that the system is interested in
-		for (auto entity : renderableEntities)
-		{
-			// Update entity position based on its velocity every frame of the game loop
-			const TransformComponent& transform = entity.transformComponent;
-			const SpriteComponent sprite = entity.spriteComponent;
-
-			// Set the source rectangle of our original sprite texture
-			SDL_Rect srcRect = sprite.srcRect;
-
-			// Set the destination rectangle with the x,y position to be rendered
-			SDL_Rect dstRect = {
-				static_cast<int>(transform.position.x - (sprite.isFixed ? 0 : camera.x)),
-				static_cast<int>(transform.position.y - (sprite.isFixed ? 0 : camera.y)),
-				static_cast<int>(sprite.width * transform.scale.x),
-				static_cast<int>(sprite.height * transform.scale.y)
-			};
-
-			SDL_RenderCopyEx(
-				renderer,
-				assetStore->GetTexture(sprite.assetId),
-				&srcRect,
-				&dstRect,
-				transform.rotation,
-				NULL,
-				SDL_FLIP_NONE
-			);
-
-			// TODO: Draw PNG textures
+				while (i < visibleSprites.ids.size() && visibleSprites.ids[i] < entity.GetId())
+				{
+					SubmitSprite(assetStore, queuedSprites[visibleSprites.ids[i++]].entity, layer.first);
+				}
+
+				const SpriteComponent& sprite = entity.GetComponent<SpriteComponent>();
+				if (!sprite.isFixed && !GetSpriteBounds(entity.GetComponent<TransformComponent>(), sprite).Overlaps(view))
+				{
+					stats.culled++;
+					continue;
+				}
+				SubmitSprite(assetStore, entity, layer.first);
+			}
+			while (i < visibleSprites.ids.size())
+			{
+				SubmitSprite(assetStore, queuedSprites[visibleSprites.ids[i++]].entity, layer.first);
+			}
+		}
+
+		// The low 32 bits hold the submission index and are already in increasing order, so only the high 4 bytes need sorting
+		stats.stateChangesBeforeSort = CountStateChanges(false);
+		RadixSort(sortKeys, sortScratch, 4);
+		stats.stateChangesAfterSort = CountStateChanges(true);
+
+		for (uint64_t key : sortKeys)
+		{
+			AddToSnapshot(snapshot, drawCommands[key & 0xFFFFFFFF], camera, alpha);
+		}
+		snapshot.stats = stats;
+
+		// Only the dirty entries are touched, the buckets can't be modified while they are iterated
+		for (const Entity& entity : dirtyEntities)
+		{
+			Dequeue(entity);
+			Enqueue(entity, entity.GetComponent<SpriteComponent>().zIndex);
 		}
+		dirtyEntities.clear();
 	}
-};
\ No newline at end of file
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../EventBus/EventBus.h"
+#include "../Events/TilemapCollisionEvent.h"
+#include <glm/glm.hpp>
+
+// Keeps the moving bodies out of the solid cells of the tilemap, they slide along the terrain instead of crossing it
+class TerrainResponseSystem : public System
+{
+public:
+	TerrainResponseSystem()
+	{
+		RequireComponent<TransformComponent>();
+		RequireComponent<RigidBodyComponent>();
+	}
+
+	void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus)
+	{
+		eventBus->SubscribeToEvent<TilemapCollisionEvent>(this, &TerrainResponseSystem::OnTilemapCollision);
+	}
+
+	void OnTilemapCollision(TilemapCollisionEvent& event)
+	{
+		if (!event.entity.HasComponent<TransformComponent>() || !event.entity.HasComponent<RigidBodyComponent>())
+		{
+			return;
+		}
+
+		// Push the body out along the contact normal
+		auto& transform = event.entity.GetComponent<TransformComponent>();
+		transform.position += event.normal * event.penetration;
+
+		// Drop the part of the velocity going into the terrain, the rest keeps the body sliding along it
+		auto& rigidbody = event.entity.GetComponent<RigidBodyComponent>();
+		const float intoTerrain = glm::dot(rigidbody.velocity, event.normal);
+		if (intoTerrain < 0.0f)
+		{
+			rigidbody.velocity -= event.normal * intoTerrain;
+		}
+	}
+};
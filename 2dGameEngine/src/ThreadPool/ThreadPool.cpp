@@ -0,0 +1,120 @@
+#include "ThreadPool.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+
+ThreadPool::ThreadPool(int numWorkers)
+{
+	for (int i = 0; i < numWorkers; i++)
+	{
+		workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+	Logger::Log("ThreadPool constructor called with " + std::to_string(workers.size()) + " workers");
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		isStopping = true;
+	}
+	jobReady.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+	Logger::Log("ThreadPool destructor called");
+}
+
+int ThreadPool::GetNumThreads() const
+{
+	return static_cast<int>(workers.size()) + 1;
+}
+
+void ThreadPool::RunTasks(const std::function<void(int)>& task, int numTasks)
+{
+	PROFILE_SCOPE("ThreadPool::RunTasks");
+	int done = 0;
+	for (int index = nextTask++; index < numTasks; index = nextTask++)
+	{
+		task(index);
+		done++;
+	}
+
+	if (done > 0 && completedTasks.fetch_add(done) + done == numTasks)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobDone.notify_all();
+	}
+}
+
+void ThreadPool::WorkerLoop()
+{
+	PROFILE_THREAD("Worker");
+	unsigned int lastGeneration = 0;
+	while (true)
+	{
+		const std::function<void(int)>* currentTask;
+		int currentNumTasks;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobReady.wait(lock, [&]() { return isStopping || generation != lastGeneration; });
+			if (isStopping)
+			{
+				return;
+			}
+			lastGeneration = generation;
+
+			// Woke up after the job already finished
+			if (!task)
+			{
+				continue;
+			}
+			currentTask = task;
+			currentNumTasks = numTasks;
+			activeWorkers++;
+		}
+
+		RunTasks(*currentTask, currentNumTasks);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		activeWorkers--;
+		if (activeWorkers == 0)
+		{
+			jobDone.notify_all();
+		}
+	}
+}
+
+void ThreadPool::ParallelFor(int numTasks, const std::function<void(int)>& task)
+{
+	if (numTasks <= 0)
+	{
+		return;
+	}
+	if (workers.empty() || numTasks == 1)
+	{
+		for (int i = 0; i < numTasks; i++)
+		{
+			task(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->task = &task;
+		this->numTasks = numTasks;
+		nextTask = 0;
+		completedTasks = 0;
+		generation++;
+	}
+	jobReady.notify_all();
+
+	// The calling thread works too instead of just waiting
+	RunTasks(task, numTasks);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	jobDone.wait(lock, [&]() { return completedTasks.load() == numTasks && activeWorkers == 0; });
+	this->task = nullptr;
+}
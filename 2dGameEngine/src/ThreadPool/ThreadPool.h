@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/*
+* Fixed set of worker threads used to split data parallel work of the systems
+* ParallelFor() hands out task indices to the workers and to the calling thread, and returns once every task ran
+*/
+class ThreadPool
+{
+private:
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable jobReady;
+	std::condition_variable jobDone;
+
+	// Current job, a new generation wakes the workers up
+	const std::function<void(int)>* task = nullptr;
+	int numTasks = 0;
+	unsigned int generation = 0;
+	bool isStopping = false;
+
+	// Workers still inside the current job, ParallelFor() waits for them so none of them can pick up a task of the next job
+	int activeWorkers = 0;
+
+	std::atomic<int> nextTask = 0;
+	std::atomic<int> completedTasks = 0;
+
+	void WorkerLoop();
+	void RunTasks(const std::function<void(int)>& task, int numTasks);
+
+public:
+	// numWorkers excludes the calling thread, so 0 runs everything on the caller
+	ThreadPool(int numWorkers = static_cast<int>(std::thread::hardware_concurrency()) - 1);
+	~ThreadPool();
+
+	// Number of threads taking part in ParallelFor(), the caller included
+	int GetNumThreads() const;
+
+	void ParallelFor(int numTasks, const std::function<void(int)>& task);
+};
@@ -0,0 +1,44 @@
+#include "Tilemap.h"
+#include "../Logger/Logger.h"
+#include <fstream>
+
+bool Tilemap::LoadFromFile(const std::string& filePath, int numCols, int numRows, int tileSize, glm::vec2 scale)
+{
+	std::fstream mapFile;
+	mapFile.open(filePath);
+	if (!mapFile.is_open())
+	{
+		Logger::Err("Error opening the tilemap " + filePath);
+		return false;
+	}
+
+	this->numCols = numCols;
+	this->numRows = numRows;
+	this->tileSize = tileSize;
+	this->scale = scale;
+	tiles.resize(numCols * numRows);
+
+	for (int y = 0; y < numRows; y++)
+	{
+		for (int x = 0; x < numCols; x++)
+		{
+			char row;
+			char col;
+			mapFile.get(row);
+			mapFile.get(col);
+			mapFile.ignore();
+
+			tiles[y * numCols + x] = (row - '0') * 10 + (col - '0');
+		}
+	}
+	if (!mapFile)
+	{
+		Logger::Err("The tilemap " + filePath + " is shorter than " + std::to_string(numCols) + "x" + std::to_string(numRows) + " tiles");
+		tiles.clear();
+		return false;
+	}
+	mapFile.close();
+
+	Logger::Log("Tilemap loaded from " + filePath);
+	return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+/*
+* Tile indices of a level map
+* In the .map files every tile is written as two digits, the row and then the column of the tile in the tileset image,
+* so the tile index is row * 10 + column
+*/
+struct Tilemap
+{
+	int numCols = 0;
+	int numRows = 0;
+	int tileSize = 0;
+	glm::vec2 scale = glm::vec2(1, 1);
+
+	// [Vector index = row * numCols + column]
+	std::vector<int> tiles;
+
+	bool LoadFromFile(const std::string& filePath, int numCols, int numRows, int tileSize, glm::vec2 scale);
+
+	int GetTile(int col, int row) const
+	{
+		return tiles[row * numCols + col];
+	}
+
+	// Position of the tile inside the tileset image
+	int GetTilesetX(int tile) const
+	{
+		return (tile % 10) * tileSize;
+	}
+
+	int GetTilesetY(int tile) const
+	{
+		return (tile / 10) * tileSize;
+	}
+
+	// Size of a tile in world units
+	glm::vec2 GetWorldTileSize() const
+	{
+		return glm::vec2(tileSize * scale.x, tileSize * scale.y);
+	}
+};
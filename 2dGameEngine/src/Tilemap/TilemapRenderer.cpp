@@ -0,0 +1,174 @@
+#include "TilemapRenderer.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+TilemapRenderer::TilemapRenderer(const Tilemap& tilemap, TextureHandle tileset) : tilemap(tilemap), tileset(tileset)
+{
+	numChunkCols = (tilemap.numCols + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	numChunkRows = (tilemap.numRows + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	chunks.resize(numChunkCols * numChunkRows);
+
+	for (int chunkRow = 0; chunkRow < numChunkRows; chunkRow++)
+	{
+		for (int chunkCol = 0; chunkCol < numChunkCols; chunkCol++)
+		{
+			Chunk& chunk = chunks[chunkRow * numChunkCols + chunkCol];
+			chunk.col = chunkCol * CHUNK_SIZE;
+			chunk.row = chunkRow * CHUNK_SIZE;
+			chunk.numCols = std::min(CHUNK_SIZE, tilemap.numCols - chunk.col);
+			chunk.numRows = std::min(CHUNK_SIZE, tilemap.numRows - chunk.row);
+		}
+	}
+}
+
+TilemapRenderer::~TilemapRenderer()
+{
+	for (auto& chunk : chunks)
+	{
+		SDL_DestroyTexture(chunk.texture);
+	}
+}
+
+void TilemapRenderer::SetTile(int col, int row, int tile)
+{
+	if (col < 0 || row < 0 || col >= tilemap.numCols || row >= tilemap.numRows)
+	{
+		return;
+	}
+	tilemap.tiles[row * tilemap.numCols + col] = tile;
+	chunks[(row / CHUNK_SIZE) * numChunkCols + col / CHUNK_SIZE].isDirty = true;
+}
+
+void TilemapRenderer::Invalidate()
+{
+	for (auto& chunk : chunks)
+	{
+		chunk.isDirty = true;
+	}
+}
+
+void TilemapRenderer::ReleaseTextures()
+{
+	for (auto& chunk : chunks)
+	{
+		SDL_DestroyTexture(chunk.texture);
+		chunk.texture = nullptr;
+		chunk.isDirty = true;
+	}
+	canBakeChunks = true;
+}
+
+void TilemapRenderer::DrawTile(SDL_Renderer* renderer, const TextureRegion& region, int tile, const SDL_Rect& dstRect) const
+{
+	const SDL_Rect tileRect = { tilemap.GetTilesetX(tile), tilemap.GetTilesetY(tile), tilemap.tileSize, tilemap.tileSize };
+	const SDL_Rect srcRect = region.ToTextureRect(tileRect);
+	SDL_RenderCopy(renderer, region.texture, &srcRect, &dstRect);
+}
+
+void TilemapRenderer::DrawTiles(SDL_Renderer* renderer, const TextureRegion& region, int minCol, int minRow, int maxCol, int maxRow, const SDL_Rect& camera) const
+{
+	const glm::vec2 tileSize = tilemap.GetWorldTileSize();
+	for (int row = minRow; row <= maxRow; row++)
+	{
+		for (int col = minCol; col <= maxCol; col++)
+		{
+			const SDL_Rect dstRect = {
+				static_cast<int>(col * tileSize.x) - camera.x,
+				static_cast<int>(row * tileSize.y) - camera.y,
+				static_cast<int>(tileSize.x),
+				static_cast<int>(tileSize.y)
+			};
+			DrawTile(renderer, region, tilemap.GetTile(col, row), dstRect);
+		}
+	}
+}
+
+bool TilemapRenderer::BakeChunk(SDL_Renderer* renderer, const TextureRegion& region, Chunk& chunk)
+{
+	// Chunks are baked at the resolution of the tileset and scaled when they are drawn
+	if (!chunk.texture)
+	{
+		chunk.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, chunk.numCols * tilemap.tileSize, chunk.numRows * tilemap.tileSize);
+		if (!chunk.texture)
+		{
+			Logger::Err("Error creating a tilemap chunk texture, the tiles are drawn one by one");
+			return false;
+		}
+		SDL_SetTextureBlendMode(chunk.texture, SDL_BLENDMODE_BLEND);
+	}
+
+	SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+	SDL_SetRenderTarget(renderer, chunk.texture);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+	SDL_RenderClear(renderer);
+
+	for (int y = 0; y < chunk.numRows; y++)
+	{
+		for (int x = 0; x < chunk.numCols; x++)
+		{
+			const SDL_Rect dstRect = { x * tilemap.tileSize, y * tilemap.tileSize, tilemap.tileSize, tilemap.tileSize };
+			DrawTile(renderer, region, tilemap.GetTile(chunk.col + x, chunk.row + y), dstRect);
+		}
+	}
+
+	SDL_SetRenderTarget(renderer, previousTarget);
+	chunk.isDirty = false;
+	numChunksBaked++;
+	return true;
+}
+
+void TilemapRenderer::Render(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, const SDL_Rect& camera)
+{
+	PROFILE_SCOPE("TilemapRenderer::Render");
+	numChunksDrawn = 0;
+	numChunksBaked = 0;
+
+	const TextureRegion& region = assetStore->GetTextureRegion(tileset);
+	if (!region.texture)
+	{
+		return;
+	}
+
+	// Tiles under the camera
+	const glm::vec2 tileSize = tilemap.GetWorldTileSize();
+	const int minCol = std::max(0, static_cast<int>(std::floor(camera.x / tileSize.x)));
+	const int minRow = std::max(0, static_cast<int>(std::floor(camera.y / tileSize.y)));
+	const int maxCol = std::min(tilemap.numCols - 1, static_cast<int>(std::floor((camera.x + camera.w) / tileSize.x)));
+	const int maxRow = std::min(tilemap.numRows - 1, static_cast<int>(std::floor((camera.y + camera.h) / tileSize.y)));
+	if (minCol > maxCol || minRow > maxRow)
+	{
+		return;
+	}
+
+	if (!canBakeChunks || !SDL_RenderTargetSupported(renderer))
+	{
+		DrawTiles(renderer, region, minCol, minRow, maxCol, maxRow, camera);
+		return;
+	}
+
+	for (int chunkRow = minRow / CHUNK_SIZE; chunkRow <= maxRow / CHUNK_SIZE; chunkRow++)
+	{
+		for (int chunkCol = minCol / CHUNK_SIZE; chunkCol <= maxCol / CHUNK_SIZE; chunkCol++)
+		{
+			Chunk& chunk = chunks[chunkRow * numChunkCols + chunkCol];
+			if (chunk.isDirty && !BakeChunk(renderer, region, chunk))
+			{
+				// Draw this frame from the tiles and stop baking until the textures are released
+				canBakeChunks = false;
+				DrawTiles(renderer, region, minCol, minRow, maxCol, maxRow, camera);
+				return;
+			}
+
+			const SDL_Rect dstRect = {
+				static_cast<int>(chunk.col * tileSize.x) - camera.x,
+				static_cast<int>(chunk.row * tileSize.y) - camera.y,
+				static_cast<int>(chunk.numCols * tileSize.x),
+				static_cast<int>(chunk.numRows * tileSize.y)
+			};
+			SDL_RenderCopy(renderer, chunk.texture, NULL, &dstRect);
+			numChunksDrawn++;
+		}
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Tilemap.h"
+#include "../AssetStore/AssetStore.h"
+#include <SDL.h>
+#include <memory>
+#include <vector>
+
+/*
+* Draws a tilemap from chunks of CHUNK_SIZE x CHUNK_SIZE tiles baked into render target textures
+* A chunk is baked the first time it is visible and again only after one of its tiles changed, so every frame costs one copy
+* per chunk under the camera whatever the size of the map. Renderers without render targets draw the visible tiles one by one.
+*/
+class TilemapRenderer
+{
+private:
+	static const int CHUNK_SIZE = 16;
+
+	struct Chunk
+	{
+		SDL_Texture* texture = nullptr;
+		// First tile and size of the chunk in tiles, the chunks of the last row and column can be smaller
+		int col = 0;
+		int row = 0;
+		int numCols = 0;
+		int numRows = 0;
+		bool isDirty = true;
+	};
+
+	Tilemap tilemap;
+	TextureHandle tileset;
+	int numChunkCols = 0;
+	int numChunkRows = 0;
+	// [Vector index = chunk row * numChunkCols + chunk column]
+	std::vector<Chunk> chunks;
+
+	int numChunksDrawn = 0;
+	int numChunksBaked = 0;
+
+	// Cleared when a chunk texture could not be created, the tiles are then drawn one by one
+	bool canBakeChunks = true;
+
+	// Returns false when the chunk texture could not be created
+	bool BakeChunk(SDL_Renderer* renderer, const TextureRegion& region, Chunk& chunk);
+	void DrawTiles(SDL_Renderer* renderer, const TextureRegion& region, int minCol, int minRow, int maxCol, int maxRow, const SDL_Rect& camera) const;
+	void DrawTile(SDL_Renderer* renderer, const TextureRegion& region, int tile, const SDL_Rect& dstRect) const;
+
+public:
+	TilemapRenderer(const Tilemap& tilemap, TextureHandle tileset);
+	~TilemapRenderer();
+
+	const Tilemap& GetTilemap() const
+	{
+		return tilemap;
+	}
+
+	// Change a tile, only its chunk is baked again
+	void SetTile(int col, int row, int tile);
+
+	// The content of render targets is lost when the renderer resets them, bake every chunk again
+	void Invalidate();
+
+	// The renderer reset its device and the chunk textures are gone with it, they are created and baked again
+	void ReleaseTextures();
+
+	void Render(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, const SDL_Rect& camera);
+
+	// Chunks drawn and baked during the last Render()
+	int GetNumChunksDrawn() const
+	{
+		return numChunksDrawn;
+	}
+
+	int GetNumChunksBaked() const
+	{
+		return numChunksBaked;
+	}
+};